@@ -0,0 +1,95 @@
+#include <iostream>
+#include <chrono>
+#include <memory_resource>
+#include "json.hpp"
+
+/*
+ *Measures memory used per value of a large synthetic document. All storage of
+ *loaded tree is allocated through a counting memory resource, so bytes of
+ *containers, member entries and strings are all included. Keys of up to 15
+ *bytes are stored within member entries, longer ones are not counted.
+ */
+
+class counting_resource: public std::pmr::memory_resource {
+
+	public:
+
+	size_t bytes = 0;
+	size_t blocks = 0;
+
+	private:
+
+	void *do_allocate(size_t n, size_t align) override {
+		bytes += n;
+		++blocks;
+		return std::pmr::new_delete_resource() -> allocate(n, align);
+	}
+
+	void do_deallocate(void *p, size_t n, size_t align) override {
+		bytes -= n;
+		--blocks;
+		std::pmr::new_delete_resource() -> deallocate(p, n, align);
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+		return this == &other;
+	}
+};
+
+static std::string make_document(unsigned records) {
+
+	std::string json = "[";
+
+	for ( unsigned i = 0; i < records; i++ ) {
+
+		if ( i != 0 )
+			json += ",";
+
+		json += "{\"id\": " + std::to_string(i) + ", \"score\": " + std::to_string(i * 0.25) +
+			", \"active\": " + ( i % 2 ? "true" : "false" ) + ", \"parent\": null" +
+			", \"name\": \"user" + std::to_string(i) + "\"" +
+			", \"email\": \"user" + std::to_string(i) + "@example.com\"" +
+			", \"tags\": [\"a\", \"bb\", \"ccc\"], \"position\": [" + std::to_string(i % 100) + ", " +
+			std::to_string(i % 7) + ", 0.5]}";
+	}
+
+	return json + "]";
+}
+
+static size_t count_nodes(const JSON &node) {
+
+	size_t count = 1;
+
+	if ( node.JSONType() == JSON::Class::Array )
+		for ( const auto &child : node.ArrayRange())
+			count += count_nodes(child);
+	else if ( node.JSONType() == JSON::Class::Object )
+		for ( const auto &entry : node.ObjectRange())
+			count += count_nodes(entry.second);
+
+	return count;
+}
+
+int main(int argc, char **argv) {
+
+	unsigned records = argc > 1 ? std::stoul(argv[1]) : 200000;
+	std::string json = make_document(records);
+	counting_resource resource;
+	JSON::ParseOptions options;
+
+	options.resource = &resource;
+
+	auto start = std::chrono::steady_clock::now();
+	JSON doc = JSON::Load(json, options);
+	auto end = std::chrono::steady_clock::now();
+
+	size_t nodes = count_nodes(doc);
+
+	std::cout << "sizeof(JSON): " << sizeof(JSON) << " bytes" << std::endl;
+	std::cout << "document: " << json.size() << " bytes, " << nodes << " values" << std::endl;
+	std::cout << "tree: " << resource.bytes + sizeof(JSON) << " bytes in " << resource.blocks << " allocations, " <<
+		(double)( resource.bytes + sizeof(JSON)) / nodes << " bytes per value" << std::endl;
+	std::cout << "load: " << std::chrono::duration<double>(end - start).count() << " s" << std::endl;
+
+	return 0;
+}
@@ -60,3 +60,21 @@ void array_example6() {
 
 	std::cout << "\narray example #6:\n" << msg << std::endl;
 }
+
+void array_example7() {
+
+	// arrays of at least JSON::PackThreshold numbers are packed when loaded
+	const JSON arr = JSON::Load("[0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19]");
+
+	long long sum = 0;
+	for ( long long value : arr.as_span<long long>())
+		sum += value;
+
+	// const access reads packed numbers, writing through a reference unpacks
+	JSON copy = arr;
+	copy[3] = "three";
+
+	std::cout << "\narray example #7: (packed)\nsum " << sum << ", 4th is " << arr.at(3) << ", " <<
+		arr.as_span<long long>().size() << " packed numbers\n" <<
+		"after write: " << copy.as_span<long long>().size() << " packed numbers, 4th is " << copy.at(3) << std::endl;
+}
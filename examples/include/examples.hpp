@@ -14,14 +14,30 @@ void array_example3();
 void array_example4();
 void array_example5();
 void array_example6();
+void array_example7();
 
 void tree_example1();
 void tree_example2();
 void tree_example3();
+void tree_example4();
+void tree_example5();
+void tree_example6();
 
 void load_example1();
 void load_example2();
 void load_example3();
+void load_example4();
+void load_example5();
+void load_example6();
+void load_example7();
+void load_example8();
+void load_example9();
+void load_example10();
+void load_example11();
+void load_example12();
+void load_example13();
+void load_example14();
+void load_example15();
 
 void comparison_print();
 void comparison_example1();
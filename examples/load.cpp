@@ -1,4 +1,6 @@
 #include "iostream"
+#include <filesystem>
+#include <fstream>
 #include "json.hpp"
 #include "examples.hpp"
 
@@ -26,3 +28,216 @@ void load_example3() {
 	JSON msg = JSON::Load("[1,2, true, false,\"STRING\", 1.5]");
 	std::cout << "\nload example #3:\n" << msg << std::endl;
 }
+
+void load_example4() {
+
+	// structural characters are found in a first pass, values are built in a second one
+	std::string json = "{\"name\": \"indexed\", \"list\": [1, 2.5, \"three\", null], \"nested\": {\"ok\": true}}";
+	std::error_code ec;
+	JSON msg = JSON::LoadIndexed(json, ec);
+
+	std::cout << "\nload example #4: (indexed)\n" << msg << std::endl;
+	std::cout << "same as Load: " << ( msg == JSON::Load(json) ? "yes" : "no" ) << std::endl;
+
+	// errors tell where parsing stopped
+	std::size_t offset;
+	JSON::LoadIndexed("{\"list\": [1, 2 3]}", JSON::ParseOptions(), ec, offset);
+	std::cout << ec.message() << " at offset " << offset << std::endl;
+}
+
+void load_example5() {
+
+	// input arrives in chunks, split at arbitrary positions
+	const char *chunks[] = { "{\"name\": \"str", "eam\", \"values\": [1, 2", ".5, tr", "ue]}" };
+	JSON::Parser parser;
+
+	for ( const char *chunk : chunks )
+		if ( parser.feed(chunk))
+			std::cout << "\nload example #5:\n" << parser.next() << std::endl;
+}
+
+// sums all "price" members without building a tree
+class PriceSum : public JSON::Handler {
+
+	public:
+
+	double total = 0;
+	int items = 0;
+
+	bool key(std::string_view k) override {
+		in_price = k == "price";
+		return true;
+	}
+
+	bool integral(long long i) override {
+		return floating((double)i);
+	}
+
+	bool floating(double d) override {
+		if ( in_price ) {
+			total += d;
+			items++;
+		}
+		in_price = false;
+		return true;
+	}
+
+	bool start_object() override {
+		in_price = false;
+		return true;
+	}
+
+	private:
+
+	bool in_price = false;
+};
+
+void load_example6() {
+
+	std::string json = "[{\"name\": \"apple\", \"price\": 1.25}, {\"name\": \"pear\", \"price\": 2}, {\"name\": \"plum\", \"price\": 0.5}]";
+	PriceSum sum;
+	std::error_code ec;
+
+	if ( JSON::Parse(json, sum, ec))
+		std::cout << "\nload example #6: (events)\n" << sum.items << " prices, total " << sum.total << std::endl;
+}
+
+void load_example7() {
+
+	// one document per line, lines are parsed on worker threads
+	std::string lines = "{\"id\": 1, \"name\": \"alice\"}\n{\"id\": 2, \"name\": \"bob}\n\n{\"id\": 3, \"name\": \"carol\"}\n";
+	std::vector<std::error_code> errors;
+	std::vector<JSON> docs = JSON::LoadLines(lines, errors);
+
+	std::cout << "\nload example #7: (lines)" << std::endl;
+	for ( size_t i = 0; i < docs.size(); i++ )
+		if ( errors[i] )
+			std::cout << "line " << i << ": " << errors[i].message() << std::endl;
+		else std::cout << "line " << i << ": " << docs[i].dumpMinified() << std::endl;
+}
+
+void load_example8() {
+
+	std::string path = ( std::filesystem::temp_directory_path() / "simplejson_example.json" ).string();
+	std::ofstream( path ) << "{\"file\": \"mapped\", \"values\": [1, 2, 3]}";
+
+	// regular files are memory mapped instead of being read into a string
+	std::error_code ec;
+	JSON msg = JSON::LoadFile(path, ec);
+	std::filesystem::remove(path);
+
+	std::cout << "\nload example #8: (file)\n" << msg << std::endl;
+
+	JSON::LoadFile(path, ec);
+	std::cout << "after removal: " << ec.message() << std::endl;
+}
+
+void load_example9() {
+
+	std::string json = "{\"skipped\": [1, 2, {\"deep\": [3, 4]}], \"user\": {\"name\": \"alice\", \"tags\": [\"a\", \"b\"]}}";
+
+	// only values on the way to "user" are looked at, nothing is parsed until it is converted
+	JSON::LazyView view(json);
+	JSON::LazyView user = view["user"];
+
+	std::cout << "\nload example #9: (lazy view)\n" <<
+		"name: " << user["name"].to_unescaped_string() << "\n" <<
+		"second tag: " << user["tags"][1].to_unescaped_string() << "\n" <<
+		"raw tags: " << user["tags"].raw() << "\n" <<
+		"has email: " << ( user.contains("email") ? "yes" : "no" ) << std::endl;
+}
+
+void load_example10() {
+
+	// large top-level arrays are split at element boundaries and parsed on several threads
+	std::string json = "[";
+	for ( int i = 0; i < 50000; i++ )
+		json += ( i ? ", " : "" ) + std::string("{\"id\": ") + std::to_string(i) + ", \"name\": \"item" + std::to_string(i) + "\"}";
+	json += "]";
+
+	JSON msg = JSON::LoadParallel(json, 4);
+
+	std::cout << "\nload example #10: (parallel)\n" <<
+		"input size: " << json.size() << "\n" <<
+		"elements: " << msg.size() << "\n" <<
+		"last: " << msg[49999].dumpMinified() << std::endl;
+}
+
+void load_example11() {
+
+	// strings are unescaped inside the buffer and referenced from there, buffer must outlive the result
+	char buf[] = "{\"path\": \"C:\\\\temp\\\\file.txt\", \"count\": 3}";
+	JSON msg = JSON::LoadInSitu(buf, sizeof(buf) - 1);
+	JSON copy = msg["path"];
+
+	std::cout << "\nload example #11: (in situ)\n" << msg << std::endl;
+	std::cout << "path: " << msg["path"].to_unescaped_string() << "\n" <<
+		"borrowed: " << ( msg["path"].is_borrowed() ? "yes" : "no" ) << "\n" <<
+		"copy borrowed: " << ( copy.is_borrowed() ? "yes" : "no" ) << std::endl;
+}
+
+void load_example12() {
+
+	// repeated keys of records are stored once per document, lookups still take plain strings
+	std::string json = "[{\"id\": 1, \"name\": \"alice\"}, {\"id\": 2, \"name\": \"bob\"}, {\"id\": 3, \"name\": \"carol\"}]";
+	JSON msg = JSON::Load(json);
+
+	std::cout << "\nload example #12: (keys)" << std::endl;
+	for ( auto &record : msg.ArrayRange()) {
+		std::cout << "record";
+		for ( auto &member : record.ObjectRange())
+			std::cout << " " << member.first << "=" << member.second;
+		std::cout << ( record.contains("name") ? ", named " + record.at("name").to_unescaped_string() : "" ) << std::endl;
+	}
+}
+
+void load_example13() {
+
+	// nodes, strings and keys of the previous message are reused for the next one
+	const char *messages[] = {
+		"{\"type\": \"trade\", \"price\": 101.5, \"qty\": 10}",
+		"{\"type\": \"trade\", \"price\": 101.75, \"qty\": 5}",
+		"{\"type\": \"quote\", \"price\": 101.6, \"qty\": 20}"
+	};
+	JSON::Document doc;
+
+	std::cout << "\nload example #13: (document)" << std::endl;
+	for ( const char *message : messages ) {
+		JSON &msg = doc.load_into(message);
+		std::cout << msg["type"].to_unescaped_string() << " " << msg["qty"].to_int() << " @ " << msg["price"].to_float() << std::endl;
+	}
+}
+
+void load_example14() {
+
+	// whole document comes from one arena, the arena must outlive it
+	std::pmr::monotonic_buffer_resource arena;
+	JSON::ParseOptions options;
+	options.resource = &arena;
+
+	JSON msg = JSON::Load("{\"name\": \"arena\", \"values\": [1, 2, 3], \"nested\": {\"flag\": true}}", options);
+	JSON extra = JSON::Make(JSON::Class::Object, &arena);
+	extra["added"] = "in arena";
+
+	// copies use the default resource, so they may outlive the arena
+	JSON copy = msg;
+
+	std::cout << "\nload example #14: (memory resource)\n" << msg.dumpMinified() << "\n" <<
+		extra.dumpMinified() << "\n" << "copy equal: " << ( copy == msg ? "yes" : "no" ) << std::endl;
+}
+
+void load_example15() {
+
+	// numbers keep their text, and are converted only when they are read
+	JSON::ParseOptions options;
+	options.lazy_numbers = true;
+
+	std::string json = "{\"huge\":1e400,\"id\":12345678901234567890,\"price\":235.99}";
+	JSON msg = JSON::Load(json, options);
+
+	std::cout << "\nload example #15: (lazy numbers)\n" << msg.dumpMinified() << std::endl;
+	std::cout << "unchanged: " << ( msg.dumpMinified() == json ? "yes" : "no" ) << std::endl;
+	std::cout << "price as float: " << msg["price"].to_float() << ", as int: " << msg["price"].to_int() << std::endl;
+	std::cout << "huge is infinite: " << ( std::isinf(msg["huge"].to_float()) ? "yes" : "no" ) << std::endl;
+	std::cout << "id is " << ( msg["id"].is_floating() ? "floating" : "integral" ) << std::endl;
+}
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <utility>
 #include "json.hpp"
 #include "examples.hpp"
 
@@ -38,3 +39,56 @@ void tree_example3() {
 
 	std::cout << "\ntree example #3:\n" << msg << std::endl;
 }
+
+void tree_example4() {
+
+	JSON msg = JSON::Load("{\"host\": \"localhost\", \"port\": 8080}");
+	std::string_view key = "port";
+
+	// find does not insert missing keys, unlike operator[]
+	const JSON *port = msg.find(key);
+	const JSON *user = msg.find("user");
+
+	std::cout << "\ntree example #4: (find)\n" <<
+		"port: " << ( port != nullptr ? port -> dumpMinified() : "missing" ) << "\n" <<
+		"user: " << ( user != nullptr ? user -> dumpMinified() : "missing" ) << "\n" <<
+		"size: " << msg.size() << std::endl;
+	if ( JSON *host = msg.find("host"); host != nullptr )
+		*host = "example.com";
+	std::cout << msg.dumpMinified() << std::endl;
+}
+
+void tree_example5() {
+
+	JSON list = JSON::Array();
+	for ( int i = 0; i < 3; i++ )
+		list.append(JSON({ "id", i }));
+
+	// values are moved into the object, emplace builds them from its arguments
+	JSON msg = JSON::Object();
+	msg.insert("list", std::move(list));
+	msg.emplace("name", "emplaced");
+	msg.emplace("count", 3);
+	msg.emplace("name", "replaced");
+
+	std::cout << "\ntree example #5: (insert)\n" << msg.dumpMinified() << std::endl;
+}
+
+void tree_example6() {
+
+	JSON config = JSON::Object();
+	for ( int i = 0; i < 5000; i++ )
+		config["key" + std::to_string(i)] = i;
+	config["server"] = JSON({ "host", "localhost", "ports", JSON::Array(80, 443) });
+
+	// frozen copy is read-only, its keys are found with a perfect hash
+	JSON::Frozen frozen = config.freeze();
+
+	std::cout << "\ntree example #6: (frozen)\n" <<
+		"size: " << frozen.size() << "\n" <<
+		"key4321: " << frozen["key4321"].to_int() << "\n" <<
+		"missing exists: " << ( frozen["missing"].exists() ? "yes" : "no" ) << "\n" <<
+		"server: " << frozen["server"].dumpMinified() << "\n" <<
+		"second port: " << frozen["server"]["ports"][1].to_int() << "\n" <<
+		"thawed equals original: " << ( frozen.thaw().dumpMinified() == config.dumpMinified() ? "yes" : "no" ) << std::endl;
+}
@@ -1,9 +1,18 @@
 #pragma once
 
 #include <system_error>
+#include <cstdint>
+#include <cstring>
 #include <stdexcept>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <memory_resource>
+#include <unordered_map>
 #include <charconv>
+#include <string_view>
 #include <string>
+#include <vector>
 #include <deque>
 #include <cmath>
 #include <map>
@@ -14,31 +23,268 @@
  */
 class JSON final {
 
+	friend struct tree_builder;
+	friend struct indexed_parser;
+
+	public:
+
+	/**
+	 *@brief Representation of object storage, chosen per object with Make or for
+	 *whole documents with ParseOptions.
+	 */
+	enum class ObjectLayout : unsigned char {
+		/** Flat vector sorted by key. Iterates in key order, like objects always have.
+		 *Small objects are searched with binary search, larger through hash index. */
+		Sorted,
+		/** Flat vector in insertion order. Iterates, and dumps, in input order.
+		 *Small objects are searched linearly, larger through hash index. */
+		Ordered,
+		/** Like Ordered, but with hash index from the first key. For objects known
+		 *to be large. */
+		Hashed
+	};
+
+	/**
+	 *@brief Storage of object members. Members are kept in one contiguous vector of
+	 *key and value pairs. Objects with more than a few keys, and all Hashed ones, also
+	 *keep an open-addressing hash index of their positions. Interface
+	 *follows std::map, so iterators point to pairs with key in first and value in second.
+	 *Keys must not be modified through iterators.
+	 */
+	class ObjectStorage {
+
+		friend class JSON;
+
+		public:
+
+		typedef std::pair<std::string, JSON> value_type;
+		typedef std::pmr::polymorphic_allocator<value_type> allocator_type;
+		typedef std::pmr::vector<value_type>::iterator iterator;
+		typedef std::pmr::vector<value_type>::const_iterator const_iterator;
+
+		explicit ObjectStorage(const allocator_type &alloc = {}): entries(alloc), index(alloc) {}
+		ObjectStorage(ObjectLayout layout, const allocator_type &alloc): entries(alloc), index(alloc), mode(layout) {}
+		ObjectStorage(const ObjectStorage &other, const allocator_type &alloc = {}):
+			entries(other.entries, alloc), index(other.index, alloc), mode(other.mode) {}
+
+		ObjectStorage &operator=(const ObjectStorage &) = delete;
+
+		allocator_type get_allocator() const noexcept {
+			return entries.get_allocator();
+		}
+
+		ObjectLayout layout() const noexcept {
+			return mode;
+		}
+
+		iterator begin() noexcept { return entries.begin(); }
+		iterator end() noexcept { return entries.end(); }
+		const_iterator begin() const noexcept { return entries.begin(); }
+		const_iterator end() const noexcept { return entries.end(); }
+
+		std::size_t size() const noexcept {
+			return entries.size();
+		}
+
+		bool empty() const noexcept {
+			return entries.empty();
+		}
+
+		void reserve(std::size_t n) {
+			entries.reserve(n);
+		}
+
+		void shrink_to_fit() {
+			entries.shrink_to_fit();
+		}
+
+		/**
+		 *Removes all members, keeping allocated memory.
+		 *@param layout Layout to use from now on.
+		 */
+		void reset(ObjectLayout layout) noexcept {
+			entries.clear();
+			index.clear();
+			mode = layout;
+			leaked = false;
+		}
+
+		iterator find(std::string_view key) noexcept {
+			return entries.begin() + position(key);
+		}
+
+		const_iterator find(std::string_view key) const noexcept {
+			return entries.begin() + position(key);
+		}
+
+		/**
+		 *@returns value of key, inserting null value if key is missing.
+		 */
+		JSON &operator[](std::string_view key);
+
+		/**
+		 *Sets value of key, adding it if missing.
+		 */
+		void insert_or_assign(std::string key, JSON &&value);
+
+		/**
+		 *Adds member for parsers. With Sorted layout members are only appended and
+		 *object must be finished with sort() before anything else is done with it.
+		 *Other layouts insert right away.
+		 */
+		void append(std::string key, JSON &&value);
+
+		/**
+		 *Puts members added with append() in order, last one of duplicate keys wins.
+		 */
+		void sort();
+
+		private:
+
+		std::pmr::vector<value_type> entries;
+		std::pmr::vector<std::uint32_t> index; // entry position + 1, 0 for free slot
+		ObjectLayout mode = ObjectLayout::Sorted;
+		std::atomic<std::uint32_t> refs { 1 }; // JSON values sharing this storage
+		bool leaked = false; // references to members were handed out, storage is not shared
+
+		static constexpr std::size_t linear_limit = 16;
+
+		std::size_t position(std::string_view key) const noexcept;
+		JSON &add(std::string &&key, JSON &&value);
+		std::size_t slot(std::string_view key, std::size_t hash) const noexcept;
+		void reindex();
+	};
+
+	/**
+	 *@brief Storage of array elements, a std::pmr::vector shared between copies
+	 *like ObjectStorage.
+	 */
+	class ArrayStorage: public std::pmr::vector<JSON> {
+
+		friend class JSON;
+
+		public:
+
+		using std::pmr::vector<JSON>::vector;
+
+		ArrayStorage(const ArrayStorage &other, const allocator_type &alloc = {}):
+			std::pmr::vector<JSON>(other, alloc) {}
+
+		ArrayStorage &operator=(const ArrayStorage &) = delete;
+
+		private:
+
+		std::atomic<std::uint32_t> refs { 1 };
+		bool leaked = false; // references to elements were handed out, storage is not shared
+	};
+
+	/**
+	 *@brief Storage of packed array, numbers of type T stored without nodes. Parsers
+	 *pack arrays of at least PackThreshold numbers of the same class, see as_span.
+	 */
+	template <typename T>
+	class PackedStorage: public std::pmr::vector<T> {
+
+		friend class JSON;
+
+		public:
+
+		using std::pmr::vector<T>::vector;
+
+		PackedStorage(const PackedStorage &other, const typename std::pmr::vector<T>::allocator_type &alloc = {}):
+			std::pmr::vector<T>(other, alloc) {}
+
+		PackedStorage &operator=(const PackedStorage &) = delete;
+
+		~PackedStorage() {
+			DropNodes();
+		}
+
+		private:
+
+		std::atomic<std::uint32_t> refs { 1 };
+		std::atomic<ArrayStorage*> nodes { nullptr }; // elements as nodes, made for const access
+
+		void DropNodes() noexcept {
+			if ( ArrayStorage *p = nodes.exchange(nullptr, std::memory_order_acq_rel); p != nullptr )
+				JSON::Destroy(p);
+		}
+	};
+
+	/*
+	 *Storage of arrays, objects and strings. Each is allocated, together with
+	 *its contents, from a std::pmr::memory_resource given to Make or Load.
+	 *Containers from default resource are shared between copies of JSON and
+	 *copied only when one of them is about to be modified.
+	 */
+	typedef std::pmr::string StringStorage;
+
 	private:
 
+	class KeyTable;
+
 	/**
 	 *@param str String to escape
 	 *@returns A escaped version of the given string.
 	 */
-	static std::string json_escape(const std::string &str);
+	static std::string json_escape(std::string_view str);
 
 	union BackingData {
 
 		BackingData(double d): Float(d) {}
 		BackingData(long long l): Int(l) {}
 		BackingData(bool b): Bool(b) {}
-		BackingData(std::string s): String(new std::string(s)) {}
 		BackingData(): Int(0) {}
 
-		std::deque<JSON> *List;
-		std::map<std::string, JSON> *Map;
-		std::string * String;
+		ArrayStorage *List;
+		PackedStorage<double> *Floats;
+		PackedStorage<long long> *Ints;
+		ObjectStorage *Map;
+		StringStorage *String;
+		const char *Chars;
 		double Float;
 		long long Int;
 		bool Bool;
 
 	} Internal;
 
+	/*
+	 *How elements of Array are stored, kept in Small.
+	 */
+	enum class Packing : unsigned char {
+		None,
+		Floating,
+		Integral
+	};
+
+	Packing Packed() const noexcept {
+		return Type == Class::Array ? static_cast<Packing>(Small) : Packing::None;
+	}
+
+	/*
+	 *Calls f with pointer to storage of array or object, typed by what it holds.
+	 */
+	template <typename F>
+	decltype(auto) Visit(F &&f) const {
+		if ( Type == Class::Object )
+			return f(Internal.Map);
+		else if ( Packed() == Packing::Floating )
+			return f(Internal.Floats);
+		else if ( Packed() == Packing::Integral )
+			return f(Internal.Ints);
+		else return f(Internal.List);
+	}
+
+	/*
+	 *Calls f with pointer to storage of packed array.
+	 */
+	template <typename F>
+	decltype(auto) VisitPacked(F &&f) const {
+		if ( Packed() == Packing::Floating )
+			return f(Internal.Floats);
+		else return f(Internal.Ints);
+	}
+
 	public:
 
 	/**
@@ -60,7 +306,11 @@ class JSON final {
 		bool_wrong_text,
 		bool_conversion_failed,
 		null_wrong_text,
-		unknown_starting_char
+		unknown_starting_char,
+		string_missing_end_quote,
+		unexpected_end_of_input,
+		depth_limit_exceeded,
+		blank_line
 	};
 
 	/**
@@ -94,7 +344,7 @@ class JSON final {
 		return { static_cast<int> (e), json_error_category };
 	};
 
-	enum class Class {
+	enum class Class : unsigned char {
 		Null,
 		Object,
 		Array,
@@ -104,14 +354,71 @@ class JSON final {
 		Boolean
 	};
 
+	class Parser;
+	class Handler;
+	class LazyView;
+	class Document;
+	class FrozenView;
+	class Frozen;
+
+	/**
+	 *@brief Options for parsing.
+	 */
+	struct ParseOptions {
+		/** Maximum nesting depth of arrays and objects, deeper input fails with
+		 *error::depth_limit_exceeded. 0 means no limit. */
+		unsigned max_depth = 1024;
+		/** Memory resource for containers and strings of loaded documents,
+		 *nullptr for default resource. Must outlive the documents. */
+		std::pmr::memory_resource *resource = nullptr;
+		/** Storage layout of loaded objects. */
+		ObjectLayout object_layout = ObjectLayout::Sorted;
+		/** Pack arrays of at least PackThreshold numbers that are all Floating
+		 *or all Integral, see as_span. */
+		bool pack_arrays = true;
+		/** Keep numbers as their text, converting them only when read with to_int,
+		 *to_float or such. Numbers are dumped with their original text. */
+		bool lazy_numbers = false;
+	};
+
+	/**
+	 *Arrays of numbers are packed by parsers when they have at least this many elements.
+	 */
+	static constexpr std::size_t PackThreshold = 16;
+
+	/**
+	 *@brief Read-only view of contiguous elements, returned by as_span.
+	 */
+	template <typename T>
+	class Span {
+
+		public:
+
+		Span() = default;
+		Span(const T *data, std::size_t size): ptr(data), count(size) {}
+
+		const T *data() const noexcept { return ptr; }
+		std::size_t size() const noexcept { return count; }
+		bool empty() const noexcept { return count == 0; }
+		const T *begin() const noexcept { return ptr; }
+		const T *end() const noexcept { return ptr + count; }
+		const T &operator[](std::size_t i) const noexcept { return ptr[i]; }
+
+		private:
+
+		const T *ptr = nullptr;
+		std::size_t count = 0;
+	};
+
 	inline static JSON Array() {
 		return JSON::Make(JSON::Class::Array);
 	}
 
 	template <typename...T >
-	inline static JSON Array(T...args) {
+	inline static JSON Array(T&&...args) {
 		JSON arr = JSON::Make(JSON::Class::Array);
-		arr.append(args...);
+		arr.reserve(sizeof...(args));
+		arr.append(std::forward<T>(args)...);
 		return arr;
 	}
 
@@ -178,44 +485,67 @@ class JSON final {
 		SetType(type);
 	}
 
+	/**
+	 *Creates object from list of keys and values. Elements of initializer list are
+	 *const and can not be moved from, values are copied, which shares their storage.
+	 */
 	JSON(std::initializer_list<JSON> list): JSON() {
 		SetType(Class::Object);
-		for ( auto i = list.begin(), e = list.end(); i != e; ++i, ++i )
-			operator[](i -> to_string()) = *std::next(i);
+		Internal.Map -> reserve(list.size() / 2);
+		for ( auto i = list.begin(), e = list.end(); i != e; ++i, ++i ) {
+			if ( i -> is_string())
+				operator[](i -> StringView()) = *std::next(i);
+			else operator[](i -> to_string()) = *std::next(i);
+		}
 	}
 
-	JSON(JSON &&other): Internal(other.Internal), Type(other.Type) {
+	JSON(JSON &&other) noexcept: Internal(other.Internal), Slice(other.Slice), SmallTail(other.SmallTail), Small(other.Small), Type(other.Type) {
 		other.Type = Class::Null;
 		other.Internal.Map = nullptr;
+		other.Slice = 0;
+		other.Small = 0;
 	}
 
-	JSON &operator=(JSON && other) {
+	JSON &operator=(JSON && other) noexcept {
 		ClearInternal();
 		Internal = other.Internal;
+		Slice = other.Slice;
+		SmallTail = other.SmallTail;
+		Small = other.Small;
 		Type = other.Type;
 		other.Internal.Map = nullptr;
+		other.Slice = 0;
+		other.Small = 0;
 		other.Type = Class::Null;
 		return *this;
 	}
 
+	/**
+	 *Copies are O(1) for arrays and objects: storage is shared and copied one level
+	 *at a time, when a copy is modified through operator[], at, append, reserve,
+	 *shrink_to_fit or ArrayRange/ObjectRange, reading copies through const access
+	 *copies nothing. Storage that references were taken into, through non-const
+	 *operator[], at, find, insert, emplace or ArrayRange/ObjectRange, is no longer
+	 *shared and is copied right away, like storage allocated from memory resource
+	 *other than the default one.
+	 */
 	JSON(const JSON &other) {
 		switch (other.Type) {
 			case Class::Object:
-				Internal.Map =
-					new std::map<std::string, JSON>(other.Internal.Map -> begin(),
-						other.Internal.Map -> end());
-				break;
 			case Class::Array:
-				Internal.List =
-					new std::deque<JSON>(other.Internal.List -> begin(),
-						other.Internal.List -> end());
+				if ( other.Shareable()) {
+					other.Share();
+					Internal = other.Internal;
+					Small = other.Small;
+				} else *this = other.CopyTree();
 				break;
 			case Class::String:
-				Internal.String =
-					new std::string(*other.Internal.String);
+				SetString(other.StringView());
 				break;
 			default:
-				Internal = other.Internal;
+				if ( other.Raw())
+					*this = MakeRaw(other.RawText(), other.Type);
+				else Internal = other.Internal;
 		}
 
 		Type = other.Type;
@@ -223,43 +553,12 @@ class JSON final {
 
 	JSON &operator=(const JSON &other) {
 		if ( &other == this ) return *this;
-		ClearInternal();
-		switch (other.Type) {
-			case Class::Object:
-				Internal.Map =
-					new std::map<std::string, JSON> (other.Internal.Map -> begin(),
-						other.Internal.Map -> end());
-				break;
-			case Class::Array:
-				Internal.List =
-					new std::deque<JSON> (other.Internal.List -> begin(),
-						other.Internal.List -> end());
-				break;
-			case Class::String:
-				Internal.String =
-					new std::string(*other.Internal.String);
-				break;
-			default:
-				Internal = other.Internal;
-		}
-
-		Type = other.Type;
-		return *this;
+		// copied first, other may be part of this
+		return *this = JSON(other);
 	}
 
 	~JSON() {
-		switch (Type) {
-			case Class::Array:
-				delete Internal.List;
-				break;
-			case Class::Object:
-				delete Internal.Map;
-				break;
-			case Class::String:
-				delete Internal.String;
-				break;
-			default: ;
-		}
+		ClearInternal();
 	}
 
 	template <typename T>
@@ -272,7 +571,11 @@ class JSON final {
 	JSON(T f, typename std::enable_if<std::is_floating_point<T>::value>::type* = 0): Internal((double) f), Type(Class::Floating) {}
 
 	template <typename T>
-	JSON(T s, typename std::enable_if<std::is_convertible<T, std::string >::value>::type* = 0): Internal(std::string(s)), Type(Class::String) {}
+	JSON(T s, typename std::enable_if<std::is_convertible<T, std::string >::value>::type* = 0): JSON() {
+		if constexpr ( std::is_convertible<T, std::string_view>::value )
+			SetString(s);
+		else SetString(std::string(std::move(s)));
+	}
 
 	JSON(std::nullptr_t): Internal(), Type(Class::Null) {}
 
@@ -285,684 +588,2314 @@ class JSON final {
 		return JSON(type);
 	}
 
+	/**
+	 *Creates a new JSON object, allocating its storage from resource.
+	 *Containers keep using resource for their contents, so resource must
+	 *outlive the object. Copies use the default resource.
+	 *@param type Class type to create.
+	 *@param resource Memory resource, nullptr for default resource.
+	 *@returns JSON object of given class type.
+	 */
+	static JSON Make(Class type, std::pmr::memory_resource *resource) {
+		JSON obj;
+		obj.SetType(type, resource);
+		return obj;
+	}
+
+	/**
+	 *Creates a new empty object with chosen storage layout.
+	 *@param type Class type to create, must be Class::Object.
+	 *@param layout Storage layout of object.
+	 *@param resource Memory resource, nullptr for default resource.
+	 *@returns JSON object of given class type.
+	 */
+	static JSON Make(Class type, ObjectLayout layout, std::pmr::memory_resource *resource = nullptr) {
+		JSON obj = Make(type, resource);
+		if ( obj.Type == Class::Object )
+			obj.Internal.Map -> reset(layout);
+		return obj;
+	}
+
 	/**
 	 *Create a JSON object from string, throws std::error_code on error.
+	 *Input is parsed in place, no copy of the string is made.
 	 *@param str JSON string to parse and load.
 	 *@returns New JSON object representing the json defined by the parsed string.
 	 */
-	static JSON Load(const std::string &str);
+	static JSON Load(std::string_view str);
 
 	/**
 	 *Create a JSON object from string.
+	 *Input is parsed in place, no copy of the string is made.
 	 *@param str JSON string to parse and load.
 	 *@param ec[OUT] Output parameter giving feedback if parsing was successful.
 	 *@returns New JSON object representing the json defined by the parsed string.
 	 */
-	static JSON Load(const std::string &str, std::error_code &ec) noexcept;
+	static JSON Load(std::string_view str, std::error_code &ec) noexcept;
 
 	/**
-	 *Allows appending items to array. Appending to a non-array will turn the object into an array with the
-	 *first element being the value that's being appended.
-	 *@param arg Item to append.
+	 *Create a JSON object from raw buffer, throws std::error_code on error.
+	 *Buffer does not need to be null terminated.
+	 *@param data Pointer to first character of JSON text.
+	 *@param len Length of JSON text in bytes.
+	 *@returns New JSON object representing the json defined by the parsed buffer.
 	 */
-	template <typename T>
-	void append(T arg) {
-		SetType(Class::Array);
-		Internal.List -> emplace_back(arg);
-	}
+	static JSON Load(const char *data, size_t len);
 
 	/**
-	 *Allows appending items to array. Appending to a non-array will turn the object into an array with the
-	 *first element being the value that's being appended.
-	 *@param arg Item to append.
-	 *@param args Further items to append.
+	 *Create a JSON object from raw buffer.
+	 *Buffer does not need to be null terminated.
+	 *@param data Pointer to first character of JSON text.
+	 *@param len Length of JSON text in bytes.
+	 *@param ec[OUT] Output parameter giving feedback if parsing was successful.
+	 *@returns New JSON object representing the json defined by the parsed buffer.
 	 */
-	template <typename T, typename...U >
-	void append(T arg, U...args) {
-		append(arg);
-		append(args...);
-	}
-
-	template <typename T>
-	typename std::enable_if<std::is_same<T, bool>::value, JSON &>::type operator=(T b) {
-		SetType(Class::Boolean);
-		Internal.Bool = b;
-		return *this;
-	}
-
-	template <typename T>
-	typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, JSON &>::type operator=(T i) {
-		SetType(Class::Integral);
-		Internal.Int = i;
-		return *this;
-	}
-
-	template <typename T>
-	typename std::enable_if<std::is_floating_point<T>::value, JSON &>::type operator=(T f) {
-		SetType(Class::Floating);
-		Internal.Float = f;
-		return *this;
-	}
-
-	template <typename T>
-	typename std::enable_if<std::is_convertible<T, std::string >::value, JSON &>::type operator=(T s) {
-		SetType(Class::String); *Internal.String = std::string(s);
-		return *this;
-	}
+	static JSON Load(const char *data, size_t len, std::error_code &ec) noexcept;
 
 	/**
-	 *Allows accessing and creating object entries by key.
-	 *@param key Key to access, will be created if not existent.
-	 *@returns The object stored at key.
+	 *Create a JSON object from string with parsing options, throws std::error_code on error.
+	 *@param str JSON string to parse.
+	 *@param options Parsing options.
+	 *@returns JSON object.
 	 */
-	JSON &operator[](const std::string &key) {
-		SetType(Class::Object);
-		return Internal.Map -> operator[](key);
-	}
+	static JSON Load(std::string_view str, const ParseOptions &options);
 
 	/**
-	 *Allows accessing and creating array entries by index.
-	 *@param index Index to access, will be created if not existent.
-	 *@returns The object stored at index.
+	 *Create a JSON object from string with parsing options.
+	 *@param str JSON string to parse.
+	 *@param options Parsing options.
+	 *@param ec[OUT] Output parameter giving feedback if parsing was successful.
+	 *@returns JSON object.
 	 */
-	JSON &operator[](unsigned index) {
-		SetType(Class::Array);
-		if ( index >= Internal.List -> size())
-			Internal.List -> resize(index + 1);
-		return Internal.List -> operator[](index);
-	}
+	static JSON Load(std::string_view str, const ParseOptions &options, std::error_code &ec) noexcept;
 
 	/**
-	 *Allows getting an object entry by key.
-	 *@param key Key to access.
-	 *@returns object entry by key.
+	 *Create a JSON object from mutable buffer, throws std::error_code on error. Strings are
+	 *unescaped in place and string values reference the buffer instead of being copied,
+	 *so buffer is modified and must outlive the returned object. Copies of string values
+	 *own their data.
+	 *@param buf Buffer holding JSON text.
+	 *@param len Length of buffer.
+	 *@returns JSON object.
 	 */
-	JSON &at(const std::string &key) {
-		return operator[](key);
-	}
+	static JSON LoadInSitu(char *buf, size_t len);
 
 	/**
-	 *Allows getting an object entry by key.
-	 *@param key Key to access.
-	 *@returns object entry by key.
+	 *Create a JSON object from mutable buffer, see LoadInSitu(char*, size_t).
+	 *@param buf Buffer holding JSON text.
+	 *@param len Length of buffer.
+	 *@param ec[OUT] Output parameter giving feedback if parsing was successful.
+	 *@returns JSON object.
 	 */
-	const JSON &at(const std::string &key) const {
-		return Internal.Map -> at(key);
-	}
+	static JSON LoadInSitu(char *buf, size_t len, std::error_code &ec) noexcept;
 
 	/**
-	 *Allows getting an array entry by index.
-	 *@param index Index to access.
-	 *@returns array entry by index.
+	 *Create a JSON object from mutable buffer with parsing options, throws std::error_code
+	 *on error, see LoadInSitu(char*, size_t).
+	 *@param buf Buffer holding JSON text.
+	 *@param len Length of buffer.
+	 *@param options Parsing options.
+	 *@returns JSON object.
 	 */
-	JSON &at(unsigned index) {
-		return operator[](index);
-	}
+	static JSON LoadInSitu(char *buf, size_t len, const ParseOptions &options);
 
 	/**
-	 *Allows getting an array entry by index.
-	 *@param index Index to access.
-	 *@returns array entry by index.
+	 *Create a JSON object from mutable buffer with parsing options, see LoadInSitu(char*, size_t).
+	 *@param buf Buffer holding JSON text.
+	 *@param len Length of buffer.
+	 *@param options Parsing options.
+	 *@param ec[OUT] Output parameter giving feedback if parsing was successful.
+	 *@returns JSON object.
 	 */
-	const JSON &at(unsigned index) const {
-		return Internal.List -> at(index);
-	}
+	static JSON LoadInSitu(char *buf, size_t len, const ParseOptions &options, std::error_code &ec) noexcept;
 
 	/**
-	 *@returns The number of items stored within an Array. -1 if 
-	 *class type is not Array.
+	 *Create a JSON object from file, throws std::error_code on error.
+	 *Regular files are memory mapped and parsed without copying, other files,
+	 *such as pipes, are read into memory first.
+	 *@param path Path of file to load.
+	 *@returns New JSON object representing the json defined by the file.
 	 */
-	std::size_t length() const {
-		return Type == Class::Array ? Internal.List -> size() : -1;
-	}
+	static JSON LoadFile(const std::string &path);
 
 	/**
-	 *@param key Key to check.
-	 *@returns true if the object holds a item with the given key, false otherwise.
+	 *Create a JSON object from file.
+	 *@param path Path of file to load.
+	 *@param ec[OUT] Output parameter giving feedback if reading and parsing was successful.
+	 *@returns New JSON object representing the json defined by the file.
 	 */
-	bool hasKey(const std::string &key) const {
-		return Type == Class::Object ? Internal.Map -> find(key) != Internal.Map -> end() : false;
-	}
-
-	bool contains(const std::string &key) const {
-		return Type == Class::Object ? Internal.Map -> find(key) != Internal.Map -> end() : false;
-	}
+	static JSON LoadFile(const std::string &path, std::error_code &ec) noexcept;
 
 	/**
-	 *@returns The number of items stored within an array or object. -1 if 
-	 *class type is neither array nor object.
+	 *Create a JSON object from file with parsing options, throws std::error_code on error.
+	 *@param path Path of file to load.
+	 *@param options Parsing options.
+	 *@returns New JSON object representing the json defined by the file.
 	 */
-	std::size_t size() const {
-		if ( Type == Class::Object)
-			return Internal.Map -> size();
-		else if ( Type == Class::Array)
-			return Internal.List -> size();
-		else
-			return -1;
-	}
+	static JSON LoadFile(const std::string &path, const ParseOptions &options);
 
 	/**
-	 *@returns Class type of the object.
+	 *Create a JSON object from file with parsing options.
+	 *@param path Path of file to load.
+	 *@param options Parsing options.
+	 *@param ec[OUT] Output parameter giving feedback if reading and parsing was successful.
+	 *@returns New JSON object representing the json defined by the file.
 	 */
-	Class JSONType() const {
-		return Type;
-	}
+	static JSON LoadFile(const std::string &path, const ParseOptions &options, std::error_code &ec) noexcept;
 
 	/**
-	 *@returns true if the object is Null, false otherwise.
+	 *Create a JSON object from string with two-stage parser, throws std::error_code on error.
+	 *First stage builds a structural index of input using SSE2 or AVX2, selected at runtime,
+	 *with scalar fallback on other platforms. Second stage builds the tree from the index.
+	 *Results and errors are identical to Load. Input that can not be indexed, because it has
+	 *single quoted strings or is 4 GiB or larger, is parsed the same way as Load does.
+	 *@param str JSON string to parse and load.
+	 *@returns New JSON object representing the json defined by the parsed string.
 	 */
-	bool is_null() const {
-		return Type == Class::Null;
+	static JSON LoadIndexed(std::string_view str);
+
+	/**
+	 *Create a JSON object from string with two-stage parser.
+	 *@param str JSON string to parse and load.
+	 *@param ec[OUT] Output parameter giving feedback if parsing was successful.
+	 *@returns New JSON object representing the json defined by the parsed string.
+	 */
+	static JSON LoadIndexed(std::string_view str, std::error_code &ec) noexcept;
+
+	/**
+	 *Create a JSON object from string with two-stage parser and parsing options,
+	 *throws std::error_code on error.
+	 *@param str JSON string to parse and load.
+	 *@param options Parsing options.
+	 *@returns New JSON object representing the json defined by the parsed string.
+	 */
+	static JSON LoadIndexed(std::string_view str, const ParseOptions &options);
+
+	/**
+	 *Create a JSON object from string with two-stage parser and parsing options.
+	 *@param str JSON string to parse and load.
+	 *@param options Parsing options.
+	 *@param ec[OUT] Output parameter giving feedback if parsing was successful.
+	 *@returns New JSON object representing the json defined by the parsed string.
+	 */
+	static JSON LoadIndexed(std::string_view str, const ParseOptions &options, std::error_code &ec) noexcept;
+
+	/**
+	 *Create a JSON object from string with two-stage parser and parsing options,
+	 *reporting where parsing stopped.
+	 *@param str JSON string to parse and load.
+	 *@param options Parsing options.
+	 *@param ec[OUT] Output parameter giving feedback if parsing was successful.
+	 *@param offset[OUT] Offset in str where parsing stopped, at the error if there was one.
+	 *@returns New JSON object representing the json defined by the parsed string.
+	 */
+	static JSON LoadIndexed(std::string_view str, const ParseOptions &options, std::error_code &ec, std::size_t &offset) noexcept;
+
+	/**
+	 *Create a JSON object from string, parsing elements of a large top-level array in parallel.
+	 *Element boundaries are found first, then ranges of elements are parsed on worker threads
+	 *and stored in order. Other input, small arrays and arrays that can not be split are parsed
+	 *with Load. Throws std::error_code on error.
+	 *@param str JSON string to parse and load.
+	 *@param threads Number of worker threads, 0 uses hardware concurrency.
+	 *@returns New JSON object representing the json defined by the parsed string.
+	 */
+	static JSON LoadParallel(std::string_view str, unsigned threads = 0);
+
+	/**
+	 *Create a JSON object from string, parsing elements of a large top-level array in parallel.
+	 *@param str JSON string to parse and load.
+	 *@param ec[OUT] Output parameter giving feedback if parsing was successful, also set
+	 *when worker threads can not be started or memory runs out.
+	 *@param threads Number of worker threads, 0 uses hardware concurrency.
+	 *@returns New JSON object representing the json defined by the parsed string.
+	 */
+	static JSON LoadParallel(std::string_view str, std::error_code &ec, unsigned threads = 0) noexcept;
+
+	/**
+	 *Create a JSON object from string with parsing options, parsing elements of a large
+	 *top-level array in parallel, throws std::error_code on error. Worker threads allocate
+	 *from options.resource at the same time, so it must be thread safe.
+	 *@param str JSON string to parse and load.
+	 *@param options Parsing options.
+	 *@param threads Number of worker threads, 0 uses hardware concurrency.
+	 *@returns New JSON object representing the json defined by the parsed string.
+	 */
+	static JSON LoadParallel(std::string_view str, const ParseOptions &options, unsigned threads = 0);
+
+	/**
+	 *Create a JSON object from string with parsing options, parsing elements of a large
+	 *top-level array in parallel.
+	 *@param str JSON string to parse and load.
+	 *@param options Parsing options.
+	 *@param ec[OUT] Output parameter giving feedback if parsing was successful, also set
+	 *when worker threads can not be started or memory runs out.
+	 *@param threads Number of worker threads, 0 uses hardware concurrency.
+	 *@returns New JSON object representing the json defined by the parsed string.
+	 */
+	static JSON LoadParallel(std::string_view str, const ParseOptions &options, std::error_code &ec, unsigned threads = 0) noexcept;
+
+	/**
+	 *Parse string and report its contents to handler as events, without building a tree.
+	 *Parsing stops when any of handler's methods returns false.
+	 *@param str JSON string to parse.
+	 *@param handler Handler receiving events.
+	 *@param ec[OUT] Output parameter giving feedback if parsing was successful.
+	 *@returns true if whole value was parsed, false on error or if handler stopped parsing.
+	 */
+	static bool Parse(std::string_view str, Handler &handler, std::error_code &ec);
+
+	/**
+	 *Parse string and report its contents to handler as events, throws std::error_code on error.
+	 *@param str JSON string to parse.
+	 *@param handler Handler receiving events.
+	 *@returns true if whole value was parsed, false if handler stopped parsing.
+	 */
+	static bool Parse(std::string_view str, Handler &handler);
+
+	/**
+	 *Parse string with parsing options and report its contents to handler as events.
+	 *Only max_depth applies, other options concern building a tree.
+	 *@param str JSON string to parse.
+	 *@param handler Handler receiving events.
+	 *@param options Parsing options.
+	 *@param ec[OUT] Output parameter giving feedback if parsing was successful.
+	 *@returns true if whole value was parsed, false on error or if handler stopped parsing.
+	 */
+	static bool Parse(std::string_view str, Handler &handler, const ParseOptions &options, std::error_code &ec);
+
+	/**
+	 *Parse string with parsing options and report its contents to handler as events,
+	 *throws std::error_code on error.
+	 *@param str JSON string to parse.
+	 *@param handler Handler receiving events.
+	 *@param options Parsing options.
+	 *@returns true if whole value was parsed, false if handler stopped parsing.
+	 */
+	static bool Parse(std::string_view str, Handler &handler, const ParseOptions &options);
+
+	/**
+	 *Load newline delimited documents (JSON Lines) from buffer. Lines are parsed in
+	 *parallel on a pool of worker threads. Every line gives one document, blank lines give
+	 *null with error::blank_line. A newline ending the buffer does not start another line.
+	 *@param str Buffer with one document per line.
+	 *@param errors[OUT] Error code for each returned document, in same order.
+	 *@param threads Number of worker threads, 0 uses hardware concurrency.
+	 *@returns Documents in the order they appear in buffer.
+	 */
+	static std::vector<JSON> LoadLines(std::string_view str, std::vector<std::error_code> &errors, unsigned threads = 0);
+
+	/**
+	 *Load newline delimited documents (JSON Lines) from buffer with parsing options. Worker
+	 *threads allocate from options.resource at the same time, so it must be thread safe.
+	 *@param str Buffer with one document per line.
+	 *@param errors[OUT] Error code for each returned document, in same order.
+	 *@param options Parsing options.
+	 *@param threads Number of worker threads, 0 uses hardware concurrency.
+	 *@returns Documents in the order they appear in buffer.
+	 */
+	static std::vector<JSON> LoadLines(std::string_view str, std::vector<std::error_code> &errors, const ParseOptions &options, unsigned threads = 0);
+
+	/**
+	 *Load newline delimited documents (JSON Lines) from buffer and pass each of them to callback.
+	 *Callback is called concurrently from worker threads, in no particular order. If it throws,
+	 *remaining lines are skipped and the first exception is rethrown once all threads have stopped.
+	 *Blank lines are passed as null with error::blank_line.
+	 *@param str Buffer with one document per line.
+	 *@param callback Called with zero based line number, document and error code of the line.
+	 *@param threads Number of worker threads, 0 uses hardware concurrency.
+	 */
+	static void LoadLines(std::string_view str, const std::function<void(size_t, JSON&&, const std::error_code&)> &callback, unsigned threads = 0);
+
+	/**
+	 *Load newline delimited documents (JSON Lines) from buffer with parsing options and pass
+	 *each of them to callback, see LoadLines(std::string_view, const std::function&, unsigned).
+	 *@param str Buffer with one document per line.
+	 *@param callback Called with zero based line number, document and error code of the line.
+	 *@param options Parsing options.
+	 *@param threads Number of worker threads, 0 uses hardware concurrency.
+	 */
+	static void LoadLines(std::string_view str, const std::function<void(size_t, JSON&&, const std::error_code&)> &callback, const ParseOptions &options, unsigned threads = 0);
+
+	/**
+	 *Load newline delimited documents (JSON Lines) from file, regular files are memory mapped.
+	 *@param path Path of file to load.
+	 *@param errors[OUT] Error code for each returned document, in same order.
+	 *@param ec[OUT] Output parameter, set if file could not be read.
+	 *@param threads Number of worker threads, 0 uses hardware concurrency.
+	 *@returns Documents in the order they appear in file.
+	 */
+	static std::vector<JSON> LoadLinesFile(const std::string &path, std::vector<std::error_code> &errors, std::error_code &ec, unsigned threads = 0);
+
+	/**
+	 *Load newline delimited documents (JSON Lines) from file with parsing options.
+	 *@param path Path of file to load.
+	 *@param errors[OUT] Error code for each returned document, in same order.
+	 *@param options Parsing options.
+	 *@param ec[OUT] Output parameter, set if file could not be read.
+	 *@param threads Number of worker threads, 0 uses hardware concurrency.
+	 *@returns Documents in the order they appear in file.
+	 */
+	static std::vector<JSON> LoadLinesFile(const std::string &path, std::vector<std::error_code> &errors, const ParseOptions &options, std::error_code &ec, unsigned threads = 0);
+
+	/**
+	 *Allows appending items to array. Appending to a non-array will turn the object into an array with the
+	 *first element being the value that's being appended. Item is forwarded, rvalues are moved in.
+	 *@param arg Item to append.
+	 */
+	template <typename T>
+	void append(T &&arg) {
+
+		typedef std::decay_t<T> V;
+
+		if constexpr ( std::is_same<V, JSON>::value ) {
+
+			// taken first, arg may be part of this
+			JSON taken(std::forward<T>(arg));
+
+			SetType(Class::Array);
+			Unpack();
+			Detach();
+			Internal.List -> push_back(std::move(taken));
+
+		} else {
+
+			SetType(Class::Array);
+
+			// number of packed type stays packed
+			if constexpr ( std::is_arithmetic<V>::value && !std::is_same<V, bool>::value ) {
+				if ( Packed() != Packing::None && ( Packed() == Packing::Floating ) == std::is_floating_point<V>::value ) {
+					Detach();
+					VisitPacked([arg](auto *p) {
+						p -> DropNodes();
+						p -> push_back(static_cast<typename std::remove_pointer_t<decltype(p)>::value_type>(arg));
+					});
+					return;
+				}
+			}
+
+			Unpack();
+			Detach();
+			Internal.List -> emplace_back(std::forward<T>(arg));
+		}
+	}
+
+	/**
+	 *Allows appending items to array. Appending to a non-array will turn the object into an array with the
+	 *first element being the value that's being appended.
+	 *@param arg Item to append.
+	 *@param args Further items to append.
+	 */
+	template <typename T, typename...U >
+	void append(T &&arg, U &&...args) {
+		append(std::forward<T>(arg));
+		append(std::forward<U>(args)...);
+	}
+
+	/**
+	 *Moves value into object entry, replacing value already stored at key. Turns
+	 *non-object into an object. Adding a key may move other values of object.
+	 *@param key Key of entry.
+	 *@param value Value to store.
+	 *@returns The value stored at key.
+	 */
+	JSON &insert(std::string_view key, JSON &&value) {
+		// taken first, value may be part of this
+		JSON taken(std::move(value));
+		SetType(Class::Object);
+		Leak();
+		return ( *Internal.Map )[key] = std::move(taken);
+	}
+
+	/**
+	 *Constructs value of object entry from args, replacing value already stored at key.
+	 *Turns non-object into an object. Adding a key may move other values of object.
+	 *@param key Key of entry.
+	 *@param args Arguments for constructing value, forwarded to a constructor of JSON.
+	 *@returns The value stored at key.
+	 */
+	template <typename...T >
+	JSON &emplace(std::string_view key, T&&...args) {
+		return insert(key, JSON(std::forward<T>(args)...));
+	}
+
+	template <typename T>
+	typename std::enable_if<std::is_same<T, bool>::value, JSON &>::type operator=(T b) {
+		SetType(Class::Boolean);
+		Internal.Bool = b;
+		return *this;
+	}
+
+	template <typename T>
+	typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, JSON &>::type operator=(T i) {
+		SetType(Class::Integral);
+		Internal.Int = i;
+		return *this;
+	}
+
+	template <typename T>
+	typename std::enable_if<std::is_floating_point<T>::value, JSON &>::type operator=(T f) {
+		SetType(Class::Floating);
+		Internal.Float = f;
+		return *this;
+	}
+
+	template <typename T>
+	typename std::enable_if<std::is_convertible<T, std::string >::value, JSON &>::type operator=(T s) {
+		if constexpr ( std::is_convertible<T, std::string_view>::value )
+			SetString(s);
+		else SetString(std::string(std::move(s)));
+		return *this;
+	}
+
+	/**
+	 *Allows accessing and creating object entries by key. Adding a key may move
+	 *other values of object, invalidating references to them.
+	 *@param key Key to access, will be created if not existent.
+	 *@returns The object stored at key.
+	 */
+	JSON &operator[](std::string_view key) {
+		SetType(Class::Object);
+		Leak();
+		return ( *Internal.Map )[key];
+	}
+
+	/**
+	 *Allows accessing and creating array entries by index. Arrays are contiguous,
+	 *growing one may move its elements, invalidating references to them.
+	 *@param index Index to access, will be created if not existent.
+	 *@returns The object stored at index.
+	 */
+	JSON &operator[](unsigned index) {
+		SetType(Class::Array);
+		Unpack();
+		Leak();
+		if ( index >= Internal.List -> size())
+			Internal.List -> resize(index + 1);
+		return Internal.List -> operator[](index);
+	}
+
+	/**
+	 *Allows getting an object entry by key.
+	 *@param key Key to access.
+	 *@returns object entry by key.
+	 */
+	JSON &at(std::string_view key) {
+		return operator[](key);
+	}
+
+	/**
+	 *Allows getting an object entry by key.
+	 *@param key Key to access.
+	 *@returns object entry by key.
+	 */
+	const JSON &at(std::string_view key) const {
+		if ( const JSON *value = find(key); value != nullptr )
+			return *value;
+		throw std::out_of_range("JSON::at: key not found");
+	}
+
+	/**
+	 *Looks up an object entry without creating it.
+	 *@param key Key to look for.
+	 *@returns pointer to entry, or nullptr if key does not exist or this is not an object.
+	 */
+	JSON *find(std::string_view key) {
+		if ( Type != Class::Object )
+			return nullptr;
+		Leak();
+		auto it = Internal.Map -> find(key);
+		return it != Internal.Map -> end() ? &it -> second : nullptr;
+	}
+
+	/**
+	 *Looks up an object entry without creating it.
+	 *@param key Key to look for.
+	 *@returns pointer to entry, or nullptr if key does not exist or this is not an object.
+	 */
+	const JSON *find(std::string_view key) const {
+		if ( Type != Class::Object )
+			return nullptr;
+		auto it = Internal.Map -> find(key);
+		return it != Internal.Map -> end() ? &it -> second : nullptr;
+	}
+
+	/**
+	 *Allows getting an array entry by index.
+	 *@param index Index to access.
+	 *@returns array entry by index.
+	 */
+	JSON &at(unsigned index) {
+		return operator[](index);
+	}
+
+	/**
+	 *Allows getting an array entry by index.
+	 *@param index Index to access.
+	 *@returns array entry by index.
+	 */
+	const JSON &at(unsigned index) const {
+		return Nodes().at(index);
+	}
+
+	/**
+	 *Reserves room for items, so that adding up to n of them does not allocate.
+	 *Objects reserve room for members, anything else is turned into an array.
+	 *@param n Number of items.
+	 */
+	void reserve(std::size_t n) {
+		if ( Type != Class::Object )
+			SetType(Class::Array);
+
+		Unpack();
+		Detach();
+
+		if ( Type == Class::Object )
+			Internal.Map -> reserve(n);
+		else Internal.List -> reserve(n);
+	}
+
+	/**
+	 *Frees memory reserved beyond current items of array or object.
+	 */
+	void shrink_to_fit() {
+		Detach();
+		if ( Type == Class::Object || Type == Class::Array )
+			Visit([](auto *p) { p -> shrink_to_fit(); });
+	}
+
+	/**
+	 *Packs array of numbers that are all Floating or all Integral, so they are stored
+	 *without nodes and available through as_span. Accessing elements through
+	 *references, or appending a different kind of value, turns it back to nodes.
+	 *@returns true if array is packed.
+	 */
+	bool pack() {
+
+		if ( Type != Class::Array )
+			return false;
+		else if ( Packed() != Packing::None )
+			return true;
+
+		const JSON *first = Internal.List -> data(), *last = first + Internal.List -> size();
+		std::pmr::memory_resource *resource = Internal.List -> get_allocator().resource();
+		JSON packed;
+
+		switch ( Packable(first, last)) {
+			case Packing::Floating:
+				packed.Adopt(Create<PackedStorage<double>>(resource));
+				Pack(*packed.Internal.Floats, first, last);
+				break;
+			case Packing::Integral:
+				packed.Adopt(Create<PackedStorage<long long>>(resource));
+				Pack(*packed.Internal.Ints, first, last);
+				break;
+			default:
+				return false;
+		}
+
+		*this = std::move(packed);
+		return true;
+	}
+
+	/**
+	 *Gives direct access to numbers of packed array.
+	 *@returns contiguous view of elements, valid until array is modified, or empty
+	 *view if this is not an array packed with elements of type T.
+	 */
+	template <typename T>
+	Span<T> as_span() const {
+
+		static_assert(std::is_same<T, double>::value || std::is_same<T, long long>::value,
+			"as_span supports double and long long");
+
+		if constexpr ( std::is_same<T, double>::value ) {
+			if ( Packed() == Packing::Floating )
+				return Span<T>(Internal.Floats -> data(), Internal.Floats -> size());
+		} else if ( Packed() == Packing::Integral )
+			return Span<T>(Internal.Ints -> data(), Internal.Ints -> size());
+
+		return Span<T>();
+	}
+
+	/**
+	 *@returns The number of items stored within an Array. -1 if 
+	 *class type is not Array.
+	 */
+	std::size_t length() const {
+		return Type == Class::Array ? Visit([](auto *p) { return p -> size(); }) : -1;
+	}
+
+	/**
+	 *@param key Key to check.
+	 *@returns true if the object holds a item with the given key, false otherwise.
+	 */
+	bool hasKey(std::string_view key) const {
+		return find(key) != nullptr;
+	}
+
+	bool contains(std::string_view key) const {
+		return find(key) != nullptr;
+	}
+
+	/**
+	 *@returns The number of items stored within an array or object. -1 if 
+	 *class type is neither array nor object.
+	 */
+	std::size_t size() const {
+		if ( Type == Class::Object)
+			return Internal.Map -> size();
+		else if ( Type == Class::Array)
+			return Visit([](auto *p) { return p -> size(); });
+		else
+			return -1;
+	}
+
+	/**
+	 *@returns Class type of the object.
+	 */
+	Class JSONType() const {
+		return Type;
+	}
+
+	/**
+	 *@returns true if the object is Null, false otherwise.
+	 */
+	bool is_null() const {
+		return Type == Class::Null;
+	}
+
+	bool is_nullptr() const {
+		return Type == Class::Null;
+	}
+
+	/**
+	 *@returns true if the object is Array, false otherwise.
+	 */
+	bool is_array() const {
+		return Type == Class::Array;
+	}
+
+	/**
+	 *@returns true if the object is Boolean, false otherwise.
+	 */
+	bool is_boolean() const {
+		return Type == Class::Boolean;
+	}
+
+	bool is_bool() const {
+		return Type == Class::Boolean;
+	}
+
+	/**
+	 *@returns true if the object is Floating, false otherwise.
+	 */
+	bool is_floating() const {
+		return Type == Class::Floating;
+	}
+
+	bool is_float() const {
+		return Type == Class::Floating;
+	}
+
+	bool is_double() const {
+		return Type == Class::Floating;
+	}
+
+	/**
+	 *@returns true if the object is Integral, false otherwise.
+	 */
+	bool is_integral() const {
+		return Type == Class::Integral;
+	}
+
+	bool is_int() const {
+		return Type == Class::Integral;
+	}
+
+	/**
+	 *@returns true if the object is String, false otherwise.
+	 */
+	bool is_string() const {
+		return Type == Class::String;
+	}
+
+	/**
+	 *@returns true if the object is a String referencing the buffer given to LoadInSitu.
+	 */
+	bool is_borrowed() const {
+		return Type == Class::String && Small == 0 && Slice != 0;
+	}
+
+	/**
+	 *@returns true if the object is a JSONObject, false otherwise.
+	 */
+	bool is_object() const {
+		return Type == Class::Object;
+	}
+
+	/**
+	 *@param ec[OUT] Output parameter giving feedback if the conversion was successful.
+	 *@returns If class type is String, the stored value. If class type is
+	 *Null, JSONObject, Array, Boolean, Floating or Integral a conversion will be tried. 
+	 *Comma of a converted Floating value depends on the users locale setting.
+	 *Returns empty string otherwise or on conversion error.
+	 */
+	std::string to_string(std::error_code &ec) const noexcept {
+
+		switch (Type) {
+			case Class::String:
+				return json_escape(StringView());
+			case Class::Object:
+			case Class::Array:
+				return dumpMinified();
+			case Class::Boolean:
+				return std::string(Internal.Bool ? "true" : "false");
+			case Class::Floating:
+				return Raw() ? std::string(RawText()) : std::to_string(Internal.Float);
+			case Class::Integral:
+				return Raw() ? std::string(RawText()) : std::to_string(Internal.Int);
+			case Class::Null:
+				return std::string("null");
+		}
+
+		ec = JSON::make_error_code(JSON::error::string_conversion_failed);
+		return std::string("");
+	}
+
+	/**
+	 *@returns If class type is String, the stored value. If class type is
+	 *Null, JSONObject, Array, Boolean, Floating or Integral a conversion will be tried. 
+	 *Comma of a converted Floating value depends on the users locale setting. Throws std::error_code
+	 *on conversion error.
+	 */
+	std::string to_string() const {
+		std::error_code ec;
+		if ( std::string ret = to_string(ec); !ec )
+			return ret;
+		else throw std::runtime_error(ec.message());;
+	}
+
+	operator std::string() const {
+		std::error_code ec;
+		if ( std::string ret = to_string(ec); !ec )
+			return ret;
+		else throw std::runtime_error(ec.message());;
+	}
+
+	/**
+	 *Useful if json objects are stored within the json as string.
+	 *@param ec[OUT] Output parameter giving feedback if the conversion was successful.
+	 *@returns If class type is String, the stored value without escaping. If class type is
+	 *Null, JSONObject, Array, Boolean, Floating or Integral a conversion will be tried. Comma of a 
+	 *converted Floating value depends on the users locale setting. Returns empty string otherwise or on conversion error.
+	 */
+	std::string to_unescaped_string(std::error_code &ec) const noexcept {
+
+		switch (Type) {
+			case Class::String:
+				return std::string(StringView());
+			case Class::Object:
+			case Class::Array:
+				return dumpMinified();
+			case Class::Boolean:
+				return std::string(Internal.Bool ? "true" : "false");
+			case Class::Floating:
+				return Raw() ? std::string(RawText()) : std::to_string(Internal.Float);
+			case Class::Integral:
+				return Raw() ? std::string(RawText()) : std::to_string(Internal.Int);
+			case Class::Null:
+				return std::string("null");
+		}
+
+		ec = JSON::make_error_code(JSON::error::string_unescaped_conversion_failed);
+		return std::string("");
+	}
+
+	/**
+	 *Useful if json objects are stored within the json as string.
+	 *@returns If class type is String, the stored value without escaping. If class type is
+	 *Null, JSONObject, Array, Boolean, Floating or Integral a conversion will be tried. Comma of a 
+	 *converted Floating value depends on the users locale setting. Throws std::error_code on conversion error.
+	 */
+	std::string to_unescaped_string() const {
+		std::error_code ec;
+		if ( std::string ret = to_unescaped_string(ec); !ec )
+			return ret;
+		else throw std::runtime_error(ec.message());;
+	}
+
+	/**
+	 *@param ec[OUT] Output parameter giving feedback if the conversion was successful.
+	 *@returns If class type is Integral, Floating or Boolean, the stored value. If the class type is
+	 *String, an conversion will be tried. 0.0 otherwise or on conversion error.
+	 */
+	double to_float(std::error_code &ec) const noexcept {
+
+		switch (Type) {
+			case Class::Floating:
+				return FloatValue();
+			case Class::Boolean:
+				return Internal.Bool;
+			case Class::Integral:
+				return static_cast<double> (IntValue());
+			case Class::String: {
+				double parsed;
+				try {
+					parsed = std::stod(std::string(StringView()));
+				} catch (const std::invalid_argument &e) {
+					(void) e;
+					ec = JSON::make_error_code(JSON::error::float_conversion_failed_invalid_arg);
+				} catch (const std::out_of_range &e) {
+					(void) e;
+					ec = JSON::make_error_code(JSON::error::float_conversion_failed_out_of_range);
+				}
+
+				if ( !ec ) return parsed;
+			}
+			default:;
+		}
+
+		ec = JSON::make_error_code(JSON::error::float_conversion_failed);
+		return 0.0;
+	}
+
+	/**
+	 *@returns If class type is Integral, Floating or Boolean, the stored value. If the class type is
+	 *String, an conversion will be tried. Throws std::error_code on conversion error.
+	 */
+	double to_float() const {
+		if ( is_null())
+			return 0;
+		std::error_code ec;
+		if ( double ret = to_float(ec); !ec )
+			return ret;
+		else throw std::runtime_error(ec.message());
+	}
+
+	double to_double(std::error_code &ec) const noexcept {
+		return to_float(ec);
+	}
+
+	double to_double() const {
+		if ( is_null())
+			return 0;
+		std::error_code ec;
+		if ( double ret = to_float(ec); !ec )
+			return ret;
+		else throw std::runtime_error(ec.message());
+	}
+
+	operator double() const {
+		if ( is_null())
+			return 0;
+		std::error_code ec;
+		if ( double ret = to_float(ec); !ec )
+			return ret;
+		else throw std::runtime_error(ec.message());
+	}
+
+	/**
+	 *@param ec[OUT] Output parameter giving feedback if the conversion was successful.
+	 *@returns If class type is Integral, Floating or Boolean, the stored value. If the class type is
+	 *String, an conversion will be tried. 0 otherwise or on conversion error.
+	 */
+	long long to_int(std::error_code &ec) const noexcept {
+
+		switch (Type) {
+			case Class::Integral:
+				return IntValue();
+			case Class::Boolean:
+				return Internal.Bool;
+			case Class::Floating:
+				return static_cast< long long > (FloatValue());
+			case Class::String: {
+				long long parsed;
+				std::string_view str = StringView();
+				std::from_chars_result result = std::from_chars(str.data(), str.data() + str.size(), parsed);
+				if ( !(bool) result.ec)
+					return parsed;
+			}
+			default:;
+		}
+
+		ec = JSON::make_error_code(JSON::error::number_conversion_failed);
+		return 0;
+	}
+
+	/**
+	 *@returns If class type is Integral, Floating or Boolean, the stored value. If the class type is
+	 *String, an conversion will be tried. Throws std::error_code on conversion error.
+	 */
+	long long to_int() const {
+		std::error_code ec;
+		if ( long long ret = to_int(ec); !ec )
+			return ret;
+		else throw std::runtime_error(ec.message());;
+	}
+
+	/**
+	 *@param ok[OUT] Output parameter giving feedback if the conversion was successful.
+	 *@returns If class type is Integral, Floating or Boolean, the stored value. If the class type is
+	 *String, an conversion will be tried. false otherwise or on conversion error.
+	 */
+	bool to_bool(std::error_code &ec) const noexcept {
+
+		switch (Type) {
+			case Class::Boolean:
+				return Internal.Bool;
+			case Class::Integral:
+				return IntValue();
+			case Class::Floating:
+				return FloatValue();
+			case Class::String: {
+				std::string_view str = StringView();
+				if ( str.find("true") != std::string_view::npos)
+					return true;
+				if ( str.find("false") != std::string_view::npos)
+					return false;
+				int parsed;
+				std::from_chars_result result = std::from_chars(str.data(), str.data() + str.size(), parsed);
+				if ( !(bool) result.ec)
+					return parsed;
+			}
+			default:;
+		}
+
+		ec = JSON::make_error_code(JSON::error::bool_conversion_failed);
+		return false;
+	}
+
+	/**
+	 *@returns If class type is Integral, Floating or Boolean, the stored value. If the class type is
+	 *String, an conversion will be tried. Throws std::error_code on conversion error.
+	 */
+	bool to_bool() const {
+		std::error_code ec;
+		if ( bool ret = to_bool(ec); !ec )
+			return ret;
+		else throw std::runtime_error(ec.message());
+	}
+
+	bool operator==(const std::string &s) const {
+		return operator std::string() == s;
+	}
+
+	bool operator==(const std::nullptr_t &n) const {
+		return is_null();
+	}
+
+	bool operator!() const {
+		if ( is_null()) return true;
+		if ( is_bool()) return to_bool() == false;
+		return false;
+	}
+
+	/**
+	 *Returns ObjectRange which allows iterating over the object items.
+	 *@returns ObjectRange which allows iterating over the object items.
+	 */
+	JSONWrapper<ObjectStorage> ObjectRange() {
+		Leak();
+		return Type == Class::Object ? JSONWrapper<ObjectStorage> (Internal.Map) :
+				JSONWrapper<ObjectStorage> (nullptr);
+	}
+
+	/**
+	 *Returns Array range which allows iterating over the array items.
+	 *@returns Array range which allows iterating over the array items.
+	 */
+	JSONWrapper<ArrayStorage> ArrayRange() {
+		Unpack();
+		Leak();
+		return Type == Class::Array ? JSONWrapper<ArrayStorage> (Internal.List) :
+			JSONWrapper<ArrayStorage> (nullptr);
+	}
+
+	/**
+	 *Returns ObjectRange which allows iterating over the object items.
+	 *@returns ObjectRange which allows iterating over the object items.
+	 */
+	JSONConstWrapper<ObjectStorage> ObjectRange() const {
+		return Type == Class::Object ? JSONConstWrapper<ObjectStorage> (Internal.Map) :
+			JSONConstWrapper<ObjectStorage> (nullptr);
+	}
+
+	/**
+	 *Returns ArrayRange which allows iterating over the array items.
+	 *@returns ArrayRange which allows iterating over the array items.
+	 */
+	JSONConstWrapper<ArrayStorage> ArrayRange() const {
+		return Type == Class::Array ? JSONConstWrapper<ArrayStorage> (&Nodes()) :
+			JSONConstWrapper<ArrayStorage> (nullptr);
+	}
+
+	/**
+	 *Makes immutable copy of this value, for documents that are built once and then
+	 *only read. Objects of the copy find their keys in constant time.
+	 *@returns Frozen copy of value.
+	 */
+	Frozen freeze() const;
+
+	/**
+	 *Returns the whole json object as formatted string.
+	 *@param depth number of indentation per level (defaults to 1)
+	 *@param tab indentation character(s) (defaults to two spaces)
+	 *@returns json object as formatted string.
+	 */
+	std::string dump(int depth = 1, std::string tab = "  ") const {
+		std::string s;
+		Write(s, depth, tab, false);
+		return s;
+	}
+
+	/**
+	 *Returns the whole json object as minified string.
+	 *@returns json object as minified string.
+	 */
+	std::string dumpMinified() const {
+		std::string s;
+		Write(s, 0, "", true);
+		return s;
+	}
+
+	friend std::ostream &operator<<(std::ostream &, const JSON &);
+
+	private:
+
+	void SetType(Class type, std::pmr::memory_resource *resource = nullptr) {
+		if ( type == Type && !Raw())
+			return;
+
+		ClearInternal();
+
+		switch (type) {
+			case Class::Null:
+				Internal.Map = nullptr;
+				break;
+			case Class::Object:
+				Internal.Map = Create<ObjectStorage>(resource);
+				break;
+			case Class::Array:
+				Internal.List = Create<ArrayStorage>(resource);
+				break;
+			case Class::String:
+				Small = 1;
+				break;
+			case Class::Floating:
+				Internal.Float = 0.0;
+				break;
+			case Class::Integral:
+				Internal.Int = 0;
+				break;
+			case Class::Boolean:
+				Internal.Bool = false;
+				break;
+		}
+
+		Type = type;
+	}
+
+	/*beware: only call if YOU know that Internal is allocated. No checks performed here.
+	    This function should be called in a constructed JSON just before you are going to
+	    overwrite Internal...
+	*/
+	void ClearInternal() {
+		switch (Type) {
+			case Class::Object:
+			case Class::Array:
+				if ( Release())
+					ClearTree();
+				Small = 0;
+				break;
+			case Class::String:
+				if ( Small == 0 && Slice == 0 )
+					Destroy(Internal.String);
+				Slice = 0;
+				Small = 0;
+				break;
+			case Class::Floating:
+			case Class::Integral:
+				if ( Small == RawHeap )
+					Destroy(Internal.String);
+				Slice = 0;
+				Small = 0;
+				break;
+			default:;
+		}
+	}
+
+	/*
+	 *Allocates and constructs storage from resource, or default resource if nullptr.
+	 *Containers are given the same resource for their contents.
+	 */
+	template <typename T, typename... Args>
+	static T *Create(std::pmr::memory_resource *resource, Args&&... args) {
+
+		std::pmr::polymorphic_allocator<T> alloc(resource != nullptr ? resource : std::pmr::get_default_resource());
+		T *p = alloc.allocate(1);
+
+		try {
+			alloc.construct(p, std::forward<Args>(args)...);
+		} catch (...) {
+			alloc.deallocate(p, 1);
+			throw;
+		}
+
+		return p;
+	}
+
+	/*
+	 *Destroys storage and returns its memory to resource it was allocated from.
+	 */
+	template <typename T>
+	static void Destroy(T *p) noexcept {
+
+		std::pmr::polymorphic_allocator<T> alloc(p -> get_allocator().resource());
+		p -> ~T();
+		alloc.deallocate(p, 1);
+	}
+
+	void ClearTree() noexcept;
+
+	/*
+	 *Appends value to s as dump or dumpMinified do. Containers are written
+	 *through an explicit stack, so deep trees do not recurse.
+	 */
+	void Write(std::string &s, int depth, std::string_view tab, bool minified) const;
+
+	/*
+	 *Copy of array or object from another memory resource, to default resource.
+	 *Unlike CopyStorage copies the whole tree, without recursion.
+	 */
+	JSON CopyTree() const;
+
+	/*
+	 *Takes ownership of storage, value must be Null.
+	 */
+	void Adopt(ObjectStorage *p) noexcept {
+		Internal.Map = p;
+		Type = Class::Object;
+	}
+
+	void Adopt(ArrayStorage *p) noexcept {
+		Internal.List = p;
+		Type = Class::Array;
+		Small = static_cast<unsigned char>(Packing::None);
+	}
+
+	void Adopt(PackedStorage<double> *p) noexcept {
+		Internal.Floats = p;
+		Type = Class::Array;
+		Small = static_cast<unsigned char>(Packing::Floating);
+	}
+
+	void Adopt(PackedStorage<long long> *p) noexcept {
+		Internal.Ints = p;
+		Type = Class::Array;
+		Small = static_cast<unsigned char>(Packing::Integral);
+	}
+
+	std::atomic<std::uint32_t> &Refs() const noexcept {
+		return Visit([](auto *p) -> std::atomic<std::uint32_t>& { return p -> refs; });
+	}
+
+	/*
+	 *Array or object storage can be shared if it lives as long as a copy would.
+	 */
+	bool Shareable() const noexcept {
+		if ( Type == Class::Object ? Internal.Map -> leaked : Packed() == Packing::None && Internal.List -> leaked )
+			return false;
+		return Visit([](auto *p) { return p -> get_allocator().resource(); }) ==
+			std::pmr::get_default_resource();
+	}
+
+	/*
+	 *Adds reference to array or object storage, for a copy.
+	 */
+	void Share() const noexcept {
+		Refs().fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/*
+	 *Drops reference to array or object storage.
+	 *@returns true when it was the last one and storage is to be freed.
+	 */
+	bool Release() const noexcept {
+		auto &refs = Refs();
+		return refs.load(std::memory_order_acquire) == 1 ||
+			refs.fetch_sub(1, std::memory_order_acq_rel) == 1;
+	}
+
+	/*
+	 *Copy of array or object storage, from default resource.
+	 */
+	JSON CopyStorage() const {
+		JSON copy;
+		Visit([&copy](auto *p) {
+			copy.Adopt(Create<std::remove_pointer_t<decltype(p)>>(nullptr, *p));
+		});
+		return copy;
+	}
+
+	/*
+	 *Makes array or object storage unique to this value before it is modified,
+	 *by copying one level of it. Elements of the copy share their storage.
+	 */
+	void Detach() {
+
+		if (( Type != Class::Object && Type != Class::Array ) ||
+			Refs().load(std::memory_order_acquire) == 1 )
+			return;
+
+		*this = CopyStorage();
+	}
+
+	/*
+	 *Detaches array or object storage and marks it as not shareable, before a
+	 *reference into it is handed out. Copies made while the reference may still
+	 *be used for writing get storage of their own.
+	 */
+	void Leak() {
+
+		Detach();
+
+		if ( Type == Class::Object )
+			Internal.Map -> leaked = true;
+		else if ( Type == Class::Array && Packed() == Packing::None )
+			Internal.List -> leaked = true;
+	}
+
+	/*
+	 *Turns packed array into array of nodes, before its elements are accessed
+	 *through references. Result is not shared.
+	 */
+	void Unpack() {
+
+		if ( Packed() == Packing::None )
+			return;
+
+		JSON list;
+		VisitPacked([&list](auto *p) {
+			list.Adopt(Create<ArrayStorage>(p -> get_allocator().resource()));
+			list.Internal.List -> reserve(p -> size());
+			for ( auto v : *p )
+				list.Internal.List -> emplace_back(v);
+		});
+
+		*this = std::move(list);
+	}
+
+	/*
+	 *@returns elements of array as nodes. Packed arrays make them once, on first
+	 *call, and keep them with packed storage until it is modified or freed.
+	 */
+	const ArrayStorage &Nodes() const {
+
+		if ( Packed() == Packing::None )
+			return *Internal.List;
+
+		return *VisitPacked([](auto *p) {
+
+			ArrayStorage *nodes = p -> nodes.load(std::memory_order_acquire);
+
+			if ( nodes == nullptr ) {
+
+				ArrayStorage *made = Create<ArrayStorage>(p -> get_allocator().resource());
+
+				try {
+					made -> reserve(p -> size());
+					for ( auto v : *p )
+						made -> emplace_back(v);
+				} catch (...) {
+					Destroy(made);
+					throw;
+				}
+
+				// another thread may have made them first
+				if ( p -> nodes.compare_exchange_strong(nodes, made, std::memory_order_acq_rel))
+					nodes = made;
+				else Destroy(made);
+			}
+
+			return nodes;
+		});
+	}
+
+	/*
+	 *@returns kind of packed array elements in [first, last) could be stored as.
+	 */
+	static Packing Packable(const JSON *first, const JSON *last) noexcept {
+
+		if ( first == last || ( first -> Type != Class::Floating && first -> Type != Class::Integral ))
+			return Packing::None;
+
+		// numbers keeping their text stay unpacked, so they are dumped as they were
+		for ( const JSON *it = first; it != last; ++it )
+			if ( it -> Type != first -> Type || it -> Raw())
+				return Packing::None;
+
+		return first -> Type == Class::Floating ? Packing::Floating : Packing::Integral;
+	}
+
+	/*
+	 *Stores numbers of [first, last) in storage, as elements of type T.
+	 */
+	template <typename T>
+	static void Pack(PackedStorage<T> &storage, const JSON *first, const JSON *last) {
+		storage.reserve(last - first);
+		for ( const JSON *it = first; it != last; ++it ) {
+			if constexpr ( std::is_same<T, double>::value )
+				storage.push_back(it -> Internal.Float);
+			else storage.push_back(it -> Internal.Int);
+		}
+	}
+
+	/*
+	 *Strings of up to SmallCapacity bytes are stored in the node itself, in the bytes of
+	 *Internal, Slice and SmallTail, with Small holding their length + 1.
+	 */
+	static constexpr std::size_t SmallCapacity = 14;
+
+	char *SmallData() {
+		return reinterpret_cast<char*>(this);
+	}
+
+	const char *SmallData() const {
+		return reinterpret_cast<const char*>(this);
+	}
+
+	std::string_view StringView() const {
+		if ( Small != 0 )
+			return std::string_view(SmallData(), Small - 1);
+		return Slice != 0 ? std::string_view(Internal.Chars, Slice - 1) : std::string_view(*Internal.String);
+	}
+
+	/*
+	 *Sets value to string s. Short strings go inline, long ones to storage allocated
+	 *from resource. Owned storage of a long string is reused, and without resource a
+	 *container being replaced passes on its resource.
+	 */
+	void SetString(std::string_view s, std::pmr::memory_resource *resource = nullptr) {
+
+		if ( Type == Class::String && Small == 0 && Slice == 0 ) {
+			Internal.String -> assign(s.data(), s.size());
+			return;
+		}
+
+		if ( resource == nullptr && ( Type == Class::Array || Type == Class::Object ))
+			resource = Visit([](auto *p) { return p -> get_allocator().resource(); });
+
+		if ( s.size() <= SmallCapacity ) {
+			char buf[SmallCapacity];
+			s.copy(buf, s.size());
+			ClearInternal();
+			std::memcpy(SmallData(), buf, s.size());
+			Small = (unsigned char)( s.size() + 1 );
+		} else {
+			StringStorage *str = Create<StringStorage>(resource, s);
+			ClearInternal();
+			Internal.String = str;
+		}
+
+		Type = Class::String;
+	}
+
+	/*
+	 *Creates String referencing s without copying it. Used by LoadInSitu,
+	 *strings not fitting in Slice are copied.
+	 */
+	static JSON MakeSlice(std::string_view s) {
+
+		if ( s.size() >= UINT32_MAX )
+			return JSON(std::string(s));
+
+		JSON str;
+		str.Internal.Chars = s.data();
+		str.Slice = (uint32_t)s.size() + 1;
+		str.Type = Class::String;
+		return str;
+	}
+
+	/*
+	 *Numbers loaded with ParseOptions::lazy_numbers keep their text, stored like a
+	 *String: inline with Small holding its length + 1, or in StringStorage with Small
+	 *set to RawHeap. Text is converted every time value is read.
+	 */
+	static constexpr unsigned char RawHeap = 255;
+
+	bool Raw() const noexcept {
+		return ( Type == Class::Floating || Type == Class::Integral ) && Small != 0;
+	}
+
+	std::string_view RawText() const noexcept {
+		return Small == RawHeap ? std::string_view(*Internal.String) : std::string_view(SmallData(), Small - 1);
+	}
+
+	/*
+	 *Creates number keeping text, which must be a valid number. Integral text
+	 *that does not fit in long long becomes Floating, like it does when parsed.
+	 */
+	static JSON MakeRaw(std::string_view text, Class type, std::pmr::memory_resource *resource = nullptr) {
+
+		JSON num;
+		long long i;
+
+		if ( type == Class::Integral && text.size() > 18 &&
+			std::from_chars(text.data(), text.data() + text.size(), i).ec != std::errc())
+			type = Class::Floating;
+
+		if ( text.size() <= SmallCapacity ) {
+			std::memcpy(num.SmallData(), text.data(), text.size());
+			num.Small = (unsigned char)( text.size() + 1 );
+		} else {
+			num.Internal.String = Create<StringStorage>(resource, text);
+			num.Small = RawHeap;
+		}
+
+		num.Type = type;
+		return num;
+	}
+
+	static double RawFloat(std::string_view text) noexcept;
+	static long long RawInt(std::string_view text) noexcept;
+
+	double FloatValue() const noexcept {
+		return Small == 0 ? Internal.Float : RawFloat(RawText());
+	}
+
+	long long IntValue() const noexcept {
+		return Small == 0 ? Internal.Int : RawInt(RawText());
+	}
+
+	/* Non-zero when String is borrowed, then Internal.Chars points to Slice - 1 characters
+	   in buffer owned by caller and there is no std::string to free. */
+	uint32_t Slice = 0;
+	uint16_t SmallTail = 0;
+	/* For String length + 1 of string stored inline, 0 if it is not. For Array
+	   how elements are stored, see Packing. For numbers non-zero when they keep
+	   their text, see Raw. */
+	unsigned char Small = 0;
+
+	Class Type = Class::Null;
+
+};
+
+/*
+ *Node layout: 8 bytes of Internal holding scalar or pointer to storage, 4 bytes of
+ *Slice, 2 bytes of SmallTail, Small and Type. Inline strings use all but the last two.
+ *Every value in a tree costs exactly this, plus key of object members.
+ */
+static_assert(sizeof(JSON) == 16, "JSON node must stay 16 bytes");
+
+/**
+ *@brief Interning table for object keys, used by parsers. Each distinct key is escaped
+ *once and kept here, object members take a copy of it. Not thread safe.
+ */
+class JSON::KeyTable {
+
+	public:
+
+	/**
+	 *Finds key from table, adding it if not found.
+	 *@param key Unescaped key.
+	 *@returns Key escaped like all object keys, valid until table is next used or cleared.
+	 */
+	const std::string &intern(std::string_view key);
+
+	/**
+	 *@returns Number of distinct keys in table.
+	 */
+	std::size_t size() const {
+		return table.size();
+	}
+
+	void clear() {
+		table.clear();
+		keys.clear();
+	}
+
+	private:
+
+	std::unordered_map<std::string_view, const std::string*> table;
+	std::deque<std::string> keys; // stay in place while more are added
+	std::string escaped;
+};
+
+/**
+ *@brief Reusable parse context for loading documents one after another. Loading replaces
+ *previous tree, and its containers, strings and object entries are kept and reused for the
+ *next one, together with interned keys and parser state. After a few documents of similar
+ *shape, loading does not allocate. Memory is kept until clear() or destruction.
+ */
+class JSON::Document {
+
+	friend struct tree_builder;
+
+	public:
+
+	Document() = default;
+
+	explicit Document(const ParseOptions &options): options(options) {}
+
+	Document(const Document &) = delete;
+	Document &operator=(const Document &) = delete;
+
+	~Document() {
+		clear();
+	}
+
+	/**
+	 *Parse string into this document, replacing previous contents.
+	 *@param str JSON string to parse.
+	 *@param ec[OUT] Output parameter giving feedback if parsing was successful.
+	 *@returns Root value, valid until next load_into or clear.
+	 */
+	JSON &load_into(std::string_view str, std::error_code &ec) noexcept;
+
+	/**
+	 *Parse string into this document, replacing previous contents, throws std::error_code on error.
+	 *@param str JSON string to parse.
+	 *@returns Root value, valid until next load_into or clear.
+	 */
+	JSON &load_into(std::string_view str);
+
+	JSON &root() {
+		return value;
 	}
 
-	bool is_nullptr() const {
-		return Type == Class::Null;
-	}
+	const JSON &root() const {
+		return value;
+	}
+
+	/**
+	 *Frees current tree and all memory kept for reuse.
+	 */
+	void clear();
+
+	private:
+
+	typedef ObjectStorage Map;
+
+	void recycle(JSON &node);
+
+	ParseOptions options;
+	JSON value;
+	KeyTable keys;
+
+	std::vector<ArrayStorage*> lists;
+	std::vector<Map*> maps;
+	std::vector<StringStorage*> strings;
+	std::vector<PackedStorage<double>*> floats;
+	std::vector<PackedStorage<long long>*> ints;
+
+	// parser state, kept for its capacity
+	std::vector<JSON> stack;
+	std::vector<std::string> stack_keys;
+	std::vector<JSON> elements;
+	std::vector<size_t> starts;
+	std::vector<bool> nesting;
+	std::vector<JSON> pending;
+	std::string buffer;
+};
+
+/**
+ *@brief Read-only view over JSON text, nothing is parsed up front. Lookups skip over
+ *values that are not needed, and values are parsed only when converted or materialized.
+ *Buffer must outlive the view and all views taken from it. Input is validated only as far
+ *as it gets parsed, so errors in skipped parts go unnoticed.
+ */
+class JSON::LazyView {
+
+	public:
+
+	/**
+	 *Creates an empty view, representing a missing value.
+	 */
+	LazyView() = default;
+
+	/**
+	 *@param str JSON text to view.
+	 */
+	explicit LazyView(std::string_view str);
+
+	/**
+	 *@param data Pointer to first character of JSON text.
+	 *@param len Length of JSON text in bytes.
+	 */
+	LazyView(const char *data, size_t len): LazyView(std::string_view(data, len)) {}
 
 	/**
-	 *@returns true if the object is Array, false otherwise.
+	 *@returns Class type of the viewed value, Null for missing values.
 	 */
-	bool is_array() const {
-		return Type == Class::Array;
-	}
+	Class JSONType() const;
 
 	/**
-	 *@returns true if the object is Boolean, false otherwise.
+	 *@returns true if view points to a value, false if value was not found.
 	 */
-	bool is_boolean() const {
-		return Type == Class::Boolean;
+	bool exists() const {
+		return !str.empty();
 	}
 
-	bool is_bool() const {
-		return Type == Class::Boolean;
+	bool is_null() const {
+		return JSONType() == Class::Null;
 	}
 
-	/**
-	 *@returns true if the object is Floating, false otherwise.
-	 */
-	bool is_floating() const {
-		return Type == Class::Floating;
+	bool is_object() const {
+		return JSONType() == Class::Object;
 	}
 
-	bool is_float() const {
-		return Type == Class::Floating;
+	bool is_array() const {
+		return JSONType() == Class::Array;
 	}
 
-	bool is_double() const {
-		return Type == Class::Floating;
+	bool is_string() const {
+		return JSONType() == Class::String;
+	}
+
+	bool is_bool() const {
+		return JSONType() == Class::Boolean;
 	}
 
-	/**
-	 *@returns true if the object is Integral, false otherwise.
-	 */
 	bool is_integral() const {
-		return Type == Class::Integral;
+		return JSONType() == Class::Integral;
 	}
 
-	bool is_int() const {
-		return Type == Class::Integral;
+	bool is_floating() const {
+		return JSONType() == Class::Floating;
 	}
 
 	/**
-	 *@returns true if the object is String, false otherwise.
+	 *@param key Key to look for, escaped like keys of loaded objects. If key appears several
+	 *times, last one is used like with Load.
+	 *@returns View of value stored at key, empty view if there is no such key.
 	 */
-	bool is_string() const {
-		return Type == Class::String;
-	}
+	LazyView operator[](std::string_view key) const;
 
 	/**
-	 *@returns true if the object is a JSONObject, false otherwise.
+	 *@param index Index of array element.
+	 *@returns View of array element, empty view if index is out of range.
 	 */
-	bool is_object() const {
-		return Type == Class::Object;
+	LazyView operator[](unsigned index) const;
+
+	/**
+	 *@param key Key to look for. Throws std::out_of_range if key does not exist.
+	 *@returns View of value stored at key.
+	 */
+	LazyView at(std::string_view key) const;
+
+	/**
+	 *@param index Index of array element. Throws std::out_of_range if index is out of range.
+	 *@returns View of array element.
+	 */
+	LazyView at(unsigned index) const;
+
+	/**
+	 *@param key Key to check.
+	 *@returns true if viewed object holds the given key.
+	 */
+	bool contains(std::string_view key) const {
+		return operator[](key).exists();
 	}
 
 	/**
-	 *@param ec[OUT] Output parameter giving feedback if the conversion was successful.
-	 *@returns If class type is String, the stored value. If class type is
-	 *Null, JSONObject, Array, Boolean, Floating or Integral a conversion will be tried. 
-	 *Comma of a converted Floating value depends on the users locale setting.
-	 *Returns empty string otherwise or on conversion error.
+	 *@returns The number of items in viewed array or object, -1 for other types.
+	 *Object members are counted as they appear, duplicate keys are counted each time.
 	 */
-	std::string to_string(std::error_code &ec) const noexcept {
+	std::size_t size() const;
 
-		switch (Type) {
-			case Class::String:
-				return json_escape(*Internal.String);
-			case Class::Object:
-			case Class::Array:
-				return dumpMinified();
-			case Class::Boolean:
-				return std::string(Internal.Bool ? "true" : "false");
-			case Class::Floating:
-				return std::to_string(Internal.Float);
-			case Class::Integral:
-				return std::to_string(Internal.Int);
-			case Class::Null:
-				return std::string("null");
-		}
+	/**
+	 *@returns JSON text of the viewed value.
+	 */
+	std::string_view raw() const;
 
-		ec = JSON::make_error_code(JSON::error::string_conversion_failed);
-		return std::string("");
+	/**
+	 *Parses viewed value.
+	 *@param ec[OUT] Output parameter giving feedback if parsing was successful.
+	 *@returns Viewed value as JSON object, same as Load would produce.
+	 */
+	JSON materialize(std::error_code &ec) const noexcept {
+		return exists() ? JSON::Load(str, ec) : JSON();
 	}
 
 	/**
-	 *@returns If class type is String, the stored value. If class type is
-	 *Null, JSONObject, Array, Boolean, Floating or Integral a conversion will be tried. 
-	 *Comma of a converted Floating value depends on the users locale setting. Throws std::error_code
-	 *on conversion error.
+	 *Parses viewed value, throws std::error_code on error.
+	 *@returns Viewed value as JSON object, same as Load would produce.
 	 */
+	JSON materialize() const {
+		return exists() ? JSON::Load(str) : JSON();
+	}
+
 	std::string to_string() const {
-		std::error_code ec;
-		if ( std::string ret = to_string(ec); !ec )
-			return ret;
-		else throw std::runtime_error(ec.message());;
+		return materialize().to_string();
+	}
+
+	std::string to_unescaped_string() const {
+		return materialize().to_unescaped_string();
+	}
+
+	double to_float() const {
+		return materialize().to_float();
+	}
+
+	double to_double() const {
+		return materialize().to_double();
+	}
+
+	long long to_int() const {
+		return materialize().to_int();
+	}
+
+	bool to_bool() const {
+		return materialize().to_bool();
+	}
+
+	operator double() const {
+		return materialize().operator double();
 	}
 
 	operator std::string() const {
-		std::error_code ec;
-		if ( std::string ret = to_string(ec); !ec )
-			return ret;
-		else throw std::runtime_error(ec.message());;
+		return materialize().operator std::string();
 	}
 
-	/**
-	 *Useful if json objects are stored within the json as string.
-	 *@param ec[OUT] Output parameter giving feedback if the conversion was successful.
-	 *@returns If class type is String, the stored value without escaping. If class type is
-	 *Null, JSONObject, Array, Boolean, Floating or Integral a conversion will be tried. Comma of a 
-	 *converted Floating value depends on the users locale setting. Returns empty string otherwise or on conversion error.
+	private:
+
+	// starts at first character of value, runs to the end of buffer
+	std::string_view str;
+};
+
+/**
+ *@brief Read-only view of a value of Frozen document. Views are small and do not own
+ *anything, the Frozen they were taken from, or a copy of it, must outlive them.
+ *Empty view represents a missing value.
+ */
+class JSON::FrozenView {
+
+	friend class JSON;
+	friend class Frozen;
+
+	/*
+	 *Values are stored in one array, children of each array and object next to each
+	 *other. Object members are found through minimal perfect hash of their keys:
+	 *hash of key selects a bucket, and seed of bucket is mixed to it to get slot of key.
+	 *slots are parallel to nodes, with object's buckets and slots at positions of its members.
+	 *Objects with keys no seed separates are probed instead: their seeds are Probed plus
+	 *number of slots from bucket its keys were placed in.
 	 */
-	std::string to_unescaped_string(std::error_code &ec) const noexcept {
+	struct Range {
+		std::uint32_t first;
+		std::uint32_t count;
+	};
 
-		switch (Type) {
-			case Class::String:
-				return std::string(*Internal.String);
-			case Class::Object:
-			case Class::Array:
-				return dumpMinified();
-			case Class::Boolean:
-				return std::string(Internal.Bool ? "true" : "false");
+	struct Node {
+		union {
+			double Float;
+			long long Int;
+			bool Bool;
+			Range Extent; // children, or characters of string in text
+		};
+		std::uint32_t key; // index in keys, NoKey if not member of object
+		Class type;
+	};
+
+	struct Slot {
+		std::uint32_t seed; // of bucket
+		std::uint32_t member; // of slot: position of member
+	};
+
+	struct KeyEntry {
+		Range chars;
+		std::size_t hash;
+	};
+
+	struct Storage {
+		std::vector<Node> nodes;
+		std::vector<Slot> slots;
+		std::vector<KeyEntry> keys;
+		std::string text;
+	};
+
+	static constexpr std::uint32_t NoKey = UINT32_MAX;
+	static constexpr std::uint32_t Probed = 0x80000000;
+	static constexpr std::uint32_t MaxSeed = 1 << 24;
+
+	/*
+	 *Maps hash mixed with seed to [0, n), seed 0 gives bucket.
+	 */
+	static std::uint32_t Reduce(std::size_t hash, std::uint32_t seed, std::uint32_t n) noexcept {
+		std::uint64_t x = ((std::uint64_t)hash ^ seed ) * 0x9E3779B97F4A7C15ULL;
+		return (std::uint32_t)((( x >> 32 ) * n ) >> 32 );
+	}
+
+	FrozenView(const Storage *data, const Node *node): data(data), node(node) {}
+
+	/*
+	 *Member of object whose children begin at first placed in slot, if it has key.
+	 */
+	FrozenView Member(std::uint32_t first, std::uint32_t slot, std::string_view key, std::size_t hash) const {
+
+		const Node *member = data -> nodes.data() + first + data -> slots[first + slot].member;
+		const KeyEntry &k = data -> keys[member -> key];
+
+		return k.hash == hash && Text(k.chars) == key ? FrozenView(data, member) : FrozenView();
+	}
+
+	std::string_view Text(Range r) const noexcept {
+		return std::string_view(data -> text.data() + r.first, r.count);
+	}
+
+	/*
+	 *Scalars are returned without allocation, strings referring to text of
+	 *document. Containers are thawed.
+	 */
+	JSON Value() const {
+		switch ( JSONType()) {
 			case Class::Floating:
-				return std::to_string(Internal.Float);
+				return JSON(node -> Float);
 			case Class::Integral:
-				return std::to_string(Internal.Int);
+				return JSON(node -> Int);
+			case Class::Boolean:
+				return JSON(node -> Bool);
+			case Class::String:
+				return JSON::MakeSlice(Text(node -> Extent));
 			case Class::Null:
-				return std::string("null");
+				return JSON();
+			default:
+				return thaw();
 		}
-
-		ec = JSON::make_error_code(JSON::error::string_unescaped_conversion_failed);
-		return std::string("");
 	}
 
+	const Storage *data = nullptr;
+	const Node *node = nullptr;
+
+	public:
+
 	/**
-	 *Useful if json objects are stored within the json as string.
-	 *@returns If class type is String, the stored value without escaping. If class type is
-	 *Null, JSONObject, Array, Boolean, Floating or Integral a conversion will be tried. Comma of a 
-	 *converted Floating value depends on the users locale setting. Throws std::error_code on conversion error.
+	 *@brief Iterates over elements of array or members of object, in order of the
+	 *value that was frozen.
 	 */
-	std::string to_unescaped_string() const {
-		std::error_code ec;
-		if ( std::string ret = to_unescaped_string(ec); !ec )
-			return ret;
-		else throw std::runtime_error(ec.message());;
+	class iterator {
+
+		public:
+
+		iterator() = default;
+		iterator(const Storage *data, const Node *node): data(data), node(node) {}
+
+		FrozenView operator*() const {
+			return FrozenView(data, node);
+		}
+
+		iterator &operator++() {
+			++node;
+			return *this;
+		}
+
+		bool operator==(const iterator &other) const {
+			return node == other.node;
+		}
+
+		bool operator!=(const iterator &other) const {
+			return node != other.node;
+		}
+
+		private:
+
+		const Storage *data = nullptr;
+		const Node *node = nullptr;
+	};
+
+	/**
+	 *Creates an empty view, representing a missing value.
+	 */
+	FrozenView() = default;
+
+	/**
+	 *@returns Class type of the viewed value, Null for missing values.
+	 */
+	Class JSONType() const {
+		return node != nullptr ? node -> type : Class::Null;
 	}
 
 	/**
-	 *@param ec[OUT] Output parameter giving feedback if the conversion was successful.
-	 *@returns If class type is Integral, Floating or Boolean, the stored value. If the class type is
-	 *String, an conversion will be tried. 0.0 otherwise or on conversion error.
+	 *@returns true if view points to a value, false if value was not found.
 	 */
-	double to_float(std::error_code &ec) const noexcept {
+	bool exists() const {
+		return node != nullptr;
+	}
 
-		switch (Type) {
-			case Class::Floating:
-				return Internal.Float;
-			case Class::Boolean:
-				return Internal.Bool;
-			case Class::Integral:
-				return static_cast<double> (Internal.Int);
-			case Class::String: {
-				double parsed;
-				try {
-					parsed = std::stod(*Internal.String);
-				} catch (const std::invalid_argument &e) {
-					(void) e;
-					ec = JSON::make_error_code(JSON::error::float_conversion_failed_invalid_arg);
-				} catch (const std::out_of_range &e) {
-					(void) e;
-					ec = JSON::make_error_code(JSON::error::float_conversion_failed_out_of_range);
-				}
+	bool is_null() const {
+		return JSONType() == Class::Null;
+	}
 
-				if ( !ec ) return parsed;
-			}
-			default:;
-		}
+	bool is_object() const {
+		return JSONType() == Class::Object;
+	}
 
-		ec = JSON::make_error_code(JSON::error::float_conversion_failed);
-		return 0.0;
+	bool is_array() const {
+		return JSONType() == Class::Array;
+	}
+
+	bool is_string() const {
+		return JSONType() == Class::String;
+	}
+
+	bool is_bool() const {
+		return JSONType() == Class::Boolean;
+	}
+
+	bool is_integral() const {
+		return JSONType() == Class::Integral;
+	}
+
+	bool is_floating() const {
+		return JSONType() == Class::Floating;
 	}
 
 	/**
-	 *@returns If class type is Integral, Floating or Boolean, the stored value. If the class type is
-	 *String, an conversion will be tried. Throws std::error_code on conversion error.
+	 *@param key Key to look for.
+	 *@returns View of value stored at key, empty view if there is no such key.
 	 */
-	double to_float() const {
-		if ( is_null())
-			return 0;
-		std::error_code ec;
-		if ( double ret = to_float(ec); !ec )
-			return ret;
-		else throw std::runtime_error(ec.message());
-	}
+	FrozenView operator[](std::string_view key) const {
+
+		if ( node == nullptr || node -> type != Class::Object || node -> Extent.count == 0 )
+			return FrozenView();
+
+		std::size_t hash = std::hash<std::string_view>()(key);
+		std::uint32_t first = node -> Extent.first, n = node -> Extent.count;
+		std::uint32_t bucket = Reduce(hash, 0, n), seed = data -> slots[first + bucket].seed;
+
+		if ( seed < Probed )
+			return Member(first, Reduce(hash, seed, n), key, hash);
 
-	double to_double(std::error_code &ec) const noexcept {
-		return to_float(ec);
+		for ( std::uint32_t slot = bucket; seed-- > Probed; slot = slot + 1 == n ? 0 : slot + 1 )
+			if ( FrozenView member = Member(first, slot, key, hash); member.exists())
+				return member;
+
+		return FrozenView();
 	}
 
-	double to_double() const {
-		if ( is_null())
-			return 0;
-		std::error_code ec;
-		if ( double ret = to_float(ec); !ec )
-			return ret;
-		else throw std::runtime_error(ec.message());
+	/**
+	 *@param index Index of array element.
+	 *@returns View of array element, empty view if index is out of range.
+	 */
+	FrozenView operator[](unsigned index) const {
+		if ( node == nullptr || node -> type != Class::Array || index >= node -> Extent.count )
+			return FrozenView();
+		return FrozenView(data, data -> nodes.data() + node -> Extent.first + index);
 	}
 
-	operator double() const {
-		if ( is_null())
-			return 0;
-		std::error_code ec;
-		if ( double ret = to_float(ec); !ec )
-			return ret;
-		else throw std::runtime_error(ec.message());
+	/**
+	 *@param key Key to look for. Throws std::out_of_range if key does not exist.
+	 *@returns View of value stored at key.
+	 */
+	FrozenView at(std::string_view key) const {
+		if ( FrozenView value = operator[](key); value.exists())
+			return value;
+		throw std::out_of_range("JSON::FrozenView::at: key not found");
 	}
 
 	/**
-	 *@param ec[OUT] Output parameter giving feedback if the conversion was successful.
-	 *@returns If class type is Integral, Floating or Boolean, the stored value. If the class type is
-	 *String, an conversion will be tried. 0 otherwise or on conversion error.
+	 *@param index Index of array element. Throws std::out_of_range if index is out of range.
+	 *@returns View of array element.
 	 */
-	long long to_int(std::error_code &ec) const noexcept {
+	FrozenView at(unsigned index) const {
+		if ( FrozenView value = operator[](index); value.exists())
+			return value;
+		throw std::out_of_range("JSON::FrozenView::at: index out of range");
+	}
 
-		switch (Type) {
-			case Class::Integral:
-				return Internal.Int;
-			case Class::Boolean:
-				return Internal.Bool;
-			case Class::Floating:
-				return static_cast< long long > (Internal.Float);
-			case Class::String: {
-				long long parsed;
-				std::from_chars_result result = std::from_chars(Internal.String -> data(), Internal.String -> data() + Internal.String -> size(), parsed);
-				if ( !(bool) result.ec)
-					return parsed;
-			}
-			default:;
-		}
+	/**
+	 *@param key Key to check.
+	 *@returns true if viewed object holds the given key.
+	 */
+	bool contains(std::string_view key) const {
+		return operator[](key).exists();
+	}
 
-		ec = JSON::make_error_code(JSON::error::number_conversion_failed);
-		return 0;
+	/**
+	 *@returns The number of items in viewed array or object, -1 for other types.
+	 */
+	std::size_t size() const {
+		return is_array() || is_object() ? node -> Extent.count : -1;
 	}
 
 	/**
-	 *@returns If class type is Integral, Floating or Boolean, the stored value. If the class type is
-	 *String, an conversion will be tried. Throws std::error_code on conversion error.
+	 *@returns Key of viewed value if it is a member of object, empty string otherwise.
 	 */
-	long long to_int() const {
-		std::error_code ec;
-		if ( long long ret = to_int(ec); !ec )
-			return ret;
-		else throw std::runtime_error(ec.message());;
+	std::string_view key() const {
+		return node != nullptr && node -> key != NoKey ? Text(data -> keys[node -> key].chars) : std::string_view();
 	}
 
 	/**
-	 *@param ok[OUT] Output parameter giving feedback if the conversion was successful.
-	 *@returns If class type is Integral, Floating or Boolean, the stored value. If the class type is
-	 *String, an conversion will be tried. false otherwise or on conversion error.
+	 *@returns Unescaped text of viewed string, valid as long as the document, or
+	 *empty string for other types.
 	 */
-	bool to_bool(std::error_code &ec) const noexcept {
+	std::string_view StringView() const {
+		return is_string() ? Text(node -> Extent) : std::string_view();
+	}
 
-		switch (Type) {
-			case Class::Boolean:
-				return Internal.Bool;
-			case Class::Integral:
-				return Internal.Int;
-			case Class::Floating:
-				return Internal.Float;
-			case Class::String: {
-				if ( Internal.String -> find("true") != std::string::npos)
-					return true;
-				if ( Internal.String -> find("false") != std::string::npos)
-					return false;
-				int parsed;
-				std::from_chars_result result = std::from_chars(Internal.String -> data(), Internal.String -> data() + Internal.String -> size(), parsed);
-				if ( !(bool) result.ec)
-					return parsed;
-			}
-			default:;
-		}
+	iterator begin() const {
+		return is_array() || is_object() ? iterator(data, data -> nodes.data() + node -> Extent.first) : iterator();
+	}
 
-		ec = JSON::make_error_code(JSON::error::bool_conversion_failed);
-		return false;
+	iterator end() const {
+		return is_array() || is_object() ? iterator(data, data -> nodes.data() + node -> Extent.first + node -> Extent.count) : iterator();
 	}
 
 	/**
-	 *@returns If class type is Integral, Floating or Boolean, the stored value. If the class type is
-	 *String, an conversion will be tried. Throws std::error_code on conversion error.
+	 *@returns Mutable copy of viewed value, same as Load would produce from it.
 	 */
+	JSON thaw() const;
+
+	std::string to_string() const {
+		return Value().to_string();
+	}
+
+	std::string to_unescaped_string() const {
+		return Value().to_unescaped_string();
+	}
+
+	double to_float() const {
+		return is_floating() ? node -> Float : Value().to_float();
+	}
+
+	double to_double() const {
+		return is_floating() ? node -> Float : Value().to_double();
+	}
+
+	long long to_int() const {
+		return is_integral() ? node -> Int : Value().to_int();
+	}
+
 	bool to_bool() const {
-		std::error_code ec;
-		if ( bool ret = to_bool(ec); !ec )
-			return ret;
-		else throw std::runtime_error(ec.message());
+		return is_bool() ? node -> Bool : Value().to_bool();
 	}
 
-	bool operator==(const std::string &s) const {
-		return operator std::string() == s;
+	operator double() const {
+		return is_floating() ? node -> Float : Value().operator double();
 	}
 
-	bool operator==(const std::nullptr_t &n) const {
-		return is_null();
+	operator std::string() const {
+		return Value().operator std::string();
 	}
 
-	bool operator!() const {
-		if ( is_null()) return true;
-		if ( is_bool()) return to_bool() == false;
-		return false;
+	std::string dump(int depth = 1, std::string tab = "  ") const {
+		return Value().dump(depth, tab);
+	}
+
+	std::string dumpMinified() const {
+		return Value().dumpMinified();
 	}
+};
+
+/**
+ *@brief Immutable document made by JSON::freeze, for documents that are built once and
+ *then read a lot, like configuration. Values are stored contiguously and every object
+ *has a minimal perfect hash of its keys, so looking up a key takes constant time. Objects
+ *with keys of same hash are probed from their bucket instead. Copies share the same
+ *storage. Nothing is modified after freezing, so any number of threads may read a
+ *document, and views taken from it, at the same time without locking.
+ */
+class JSON::Frozen {
+
+	friend class JSON;
+
+	public:
 
 	/**
-	 *Returns ObjectRange which allows iterating over the object items.
-	 *@returns ObjectRange which allows iterating over the object items.
+	 *Creates an empty document, its root is a missing value.
 	 */
-	JSONWrapper<std::map<std::string, JSON>> ObjectRange() {
-		return Type == Class::Object ? JSONWrapper<std::map<std::string, JSON>> (Internal.Map) :
-				JSONWrapper<std::map<std::string, JSON>> (nullptr);
-	}
+	Frozen() = default;
 
 	/**
-	 *Returns Array range which allows iterating over the array items.
-	 *@returns Array range which allows iterating over the array items.
+	 *@returns View of root value.
 	 */
-	JSONWrapper<std::deque < JSON>> ArrayRange() {
-		return Type == Class::Array ? JSONWrapper<std::deque < JSON>> (Internal.List) :
-			JSONWrapper<std::deque < JSON>> (nullptr);
+	FrozenView root() const {
+		return storage ? FrozenView(storage.get(), storage -> nodes.data()) : FrozenView();
+	}
+
+	FrozenView operator[](std::string_view key) const {
+		return root()[key];
+	}
+
+	FrozenView operator[](unsigned index) const {
+		return root()[index];
+	}
+
+	FrozenView at(std::string_view key) const {
+		return root().at(key);
+	}
+
+	FrozenView at(unsigned index) const {
+		return root().at(index);
+	}
+
+	bool contains(std::string_view key) const {
+		return root().contains(key);
+	}
+
+	std::size_t size() const {
+		return root().size();
+	}
+
+	FrozenView::iterator begin() const {
+		return root().begin();
+	}
+
+	FrozenView::iterator end() const {
+		return root().end();
 	}
 
 	/**
-	 *Returns ObjectRange which allows iterating over the object items.
-	 *@returns ObjectRange which allows iterating over the object items.
+	 *@returns Mutable copy of document.
 	 */
-	JSONConstWrapper<std::map<std::string, JSON>> ObjectRange() const {
-		return Type == Class::Object ? JSONConstWrapper<std::map<std::string, JSON>> (Internal.Map) :
-			JSONConstWrapper<std::map<std::string, JSON>> (nullptr);
+	JSON thaw() const {
+		return root().thaw();
 	}
 
+	private:
+
+	std::shared_ptr<const FrozenView::Storage> storage;
+};
+
+/**
+ *@brief Event handler interface for JSON::Parse. Override methods of events you are interested in,
+ *return false from any of them to stop parsing. Strings and keys are unescaped and
+ *only valid during the call.
+ */
+class JSON::Handler {
+
+	public:
+
+	virtual ~Handler() = default;
+
+	virtual bool null() { return true; }
+	virtual bool boolean(bool) { return true; }
+	virtual bool integral(long long) { return true; }
+	virtual bool floating(double) { return true; }
+	virtual bool string(std::string_view) { return true; }
+	virtual bool key(std::string_view) { return true; }
+	virtual bool start_object() { return true; }
+	virtual bool end_object() { return true; }
+	virtual bool start_array() { return true; }
+	virtual bool end_array() { return true; }
+};
+
+/**
+ *@brief Incremental push parser. Input can be fed in chunks split at arbitrary positions,
+ *tree is built while data arrives and completed top-level values are queued until taken
+ *with next(). Multiple concatenated documents are supported. After an error, parser must be reset.
+ */
+class JSON::Parser {
+
+	public:
+
+	Parser() = default;
+
+	explicit Parser(const ParseOptions &options): max_depth(options.max_depth), resource(options.resource),
+		layout(options.object_layout), pack_arrays(options.pack_arrays), lazy_numbers(options.lazy_numbers) {}
+
 	/**
-	 *Returns ArrayRange which allows iterating over the array items.
-	 *@returns ArrayRange which allows iterating over the array items.
+	 *Feed next chunk of input.
+	 *@param data Pointer to chunk.
+	 *@param len Length of chunk in bytes.
+	 *@param ec[OUT] Output parameter giving feedback if parsing was successful.
+	 *@returns true if a completed top-level value is available.
 	 */
-	JSONConstWrapper<std::deque < JSON>> ArrayRange() const {
-		return Type == Class::Array ? JSONConstWrapper<std::deque < JSON>> (Internal.List) :
-			JSONConstWrapper<std::deque < JSON>> (nullptr);
-	}
+	bool feed(const char *data, size_t len, std::error_code &ec) noexcept;
 
 	/**
-	 *Returns the whole json object as formatted string.
-	 *@param depth number of indentation per level (defaults to 1)
-	 *@param tab indentation character(s) (defaults to two spaces)
-	 *@returns json object as formatted string.
+	 *Feed next chunk of input, throws std::error_code on error.
+	 *@param data Pointer to chunk.
+	 *@param len Length of chunk in bytes.
+	 *@returns true if a completed top-level value is available.
 	 */
-	std::string dump(int depth = 1, std::string tab = "  ") const {
-		switch (Type) {
-			case Class::Null:
-				return "null";
-			case Class::Object: {
-				std::string pad = "";
-				std::string s = "{\n";
-				bool skip = true;
-				for ( int i = 0; i < depth; ++i, pad += tab );
-				for ( auto &p: *Internal.Map ) {
-					if ( !skip ) s += ",\n";
-					s += ( pad + "\"" + p.first + "\" : " + p.second.dump(depth + 1, tab));
-					skip = false;
-				}
+	bool feed(const char *data, size_t len);
 
-				s += ( "\n" + pad.erase(0, tab.size()) + "}" );
-				return s;
-			}
-			case Class::Array: {
-				std::string s = "[";
-				bool skip = true;
-				for ( auto &p: *Internal.List ) {
-					if ( !skip ) s += ", ";
-					s += p.dump(depth + 1, tab);
-					skip = false;
-				}
+	bool feed(std::string_view chunk, std::error_code &ec) noexcept {
+		return feed(chunk.data(), chunk.size(), ec);
+	}
 
-				s += "]";
-				return s;
-			}
-			case Class::String:
-				return "\"" + JSON::json_escape(*Internal.String) + "\"";
-			case Class::Floating:
-				return std::to_string(Internal.Float);
-			case Class::Integral:
-				return std::to_string(Internal.Int);
-			case Class::Boolean:
-				return Internal.Bool ? "true" : "false";
-			default:
-				return "";
-		}
-		return "";
+	bool feed(std::string_view chunk) {
+		return feed(chunk.data(), chunk.size());
 	}
 
 	/**
-	 *Returns the whole json object as minified string.
-	 *@returns json object as minified string.
+	 *Signal end of input. Completes top-level scalar that was waiting for a delimiter.
+	 *@param ec[OUT] Output parameter, set if input ended within a value.
+	 *@returns true if a completed top-level value is available.
 	 */
-	std::string dumpMinified() const {
-
-		switch (Type) {
-			case Class::Null:
-				return "null";
-			case Class::Object: {
-				std::string s = "{";
-				bool skip = true;
-				for ( auto &p: *Internal.Map ) {
-					if ( !skip ) s += ",";
-					s += ( "\"" + p.first + "\":" + p.second.dumpMinified());
-					skip = false;
-				}
-				s += "}";
-				return s;
-			}
-			case Class::Array: {
-				std::string s = "[";
-				bool skip = true;
-				for ( auto &p: *Internal.List ) {
-					if ( !skip ) s += ",";
-					s += p.dumpMinified();
-					skip = false;
-				}
+	bool finish(std::error_code &ec) noexcept;
 
-				s += "]";
-				return s;
-			}
-			case Class::String:
-				return "\"" + JSON::json_escape(*Internal.String) + "\"";
-			case Class::Floating:
-				return std::to_string(Internal.Float);
-			case Class::Integral:
-				return std::to_string(Internal.Int);
-			case Class::Boolean:
-				return Internal.Bool ? "true" : "false";
-			default:
-				return "";
-		}
+	/**
+	 *Signal end of input, throws std::error_code if input ended within a value.
+	 *@returns true if a completed top-level value is available.
+	 */
+	bool finish();
 
-		return "";
+	/**
+	 *@returns true if a completed top-level value is available.
+	 */
+	bool ready() const {
+		return !completed.empty();
 	}
 
-	friend std::ostream &operator<<(std::ostream &, const JSON &);
-
-	private:
-
-	void SetType(Class type) {
-		if ( type == Type )
-			return;
+	/**
+	 *Takes oldest completed top-level value.
+	 *@returns completed value, or null if none is available.
+	 */
+	JSON next();
 
-		ClearInternal();
+	/**
+	 *Discards all state, including error and completed values.
+	 */
+	void reset();
 
-		switch (type) {
-			case Class::Null:
-				Internal.Map = nullptr;
-				break;
-			case Class::Object:
-				Internal.Map = new std::map<std::string, JSON> ();
-				break;
-			case Class::Array:
-				Internal.List = new std::deque<JSON> ();
-				break;
-			case Class::String:
-				Internal.String = new std::string();
-				break;
-			case Class::Floating:
-				Internal.Float = 0.0;
-				break;
-			case Class::Integral:
-				Internal.Int = 0;
-				break;
-			case Class::Boolean:
-				Internal.Bool = false;
-				break;
-		}
+	private:
 
-		Type = type;
-	}
+	enum class Expect : unsigned char {
+		Value,
+		ArrayValueOrEnd,
+		ArrayValue,
+		ArrayCommaOrEnd,
+		ObjectKeyOrEnd,
+		ObjectKey,
+		ObjectColon,
+		ObjectValue,
+		ObjectCommaOrEnd
+	};
 
-	/*beware: only call if YOU know that Internal is allocated. No checks performed here.
-	    This function should be called in a constructed JSON just before you are going to
-	    overwrite Internal...
-	*/
-	void ClearInternal() {
-		switch (Type) {
-			case Class::Object:
-				delete Internal.Map;
-				break;
-			case Class::Array:
-				delete Internal.List;
-				break;
-			case Class::String:
-				delete Internal.String;
-				break;
-			default:;
-		}
-	}
+	enum class Lex : unsigned char {
+		None,
+		String,
+		Escape,
+		Bare
+	};
 
-	Class Type = Class::Null;
+	struct Frame {
+		JSON value;
+		JSON key;
+		Expect expect;
+	};
 
+	bool token_start(char c);
+	bool structural(char c);
+	bool complete(JSON &&value);
+	bool complete_string();
+	bool complete_bare();
+
+	std::deque<JSON> completed;
+	std::vector<Frame> stack;
+	KeyTable keys;
+	std::string token;
+	std::error_code error;
+	Lex lex = Lex::None;
+	char tick = '\"';
+	unsigned max_depth = ParseOptions().max_depth;
+	std::pmr::memory_resource *resource = nullptr;
+	ObjectLayout layout = ObjectLayout::Sorted;
+	bool pack_arrays = ParseOptions().pack_arrays;
+	bool lazy_numbers = ParseOptions().lazy_numbers;
 };
 
 inline std::ostream &operator<<(std::ostream &os, const JSON &json) {
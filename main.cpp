@@ -18,14 +18,30 @@ int main(int argc, char **argv) {
 	array_example4();
 	array_example5();
 	array_example6();
+	array_example7();
 
 	tree_example1();
 	tree_example2();
 	tree_example3();
+	tree_example4();
+	tree_example5();
+	tree_example6();
 
 	load_example1();
 	load_example2();
 	load_example3();
+	load_example4();
+	load_example5();
+	load_example6();
+	load_example7();
+	load_example8();
+	load_example9();
+	load_example10();
+	load_example11();
+	load_example12();
+	load_example13();
+	load_example14();
+	load_example15();
 
 	comparison_print();
 	comparison_example1();
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <system_error>
+
+/*
+ *Internal read-only view of a file's contents. Regular files are memory mapped on
+ *POSIX systems, anything that can not be mapped, like pipes, is read into a buffer.
+ *Errors, running out of memory included, are reported in ec.
+ */
+class mapped_file {
+
+	public:
+
+	mapped_file(const std::string &path, std::error_code &ec) noexcept;
+	~mapped_file();
+
+	mapped_file(const mapped_file &) = delete;
+	mapped_file &operator=(const mapped_file &) = delete;
+
+	std::string_view data() const {
+		return map ? std::string_view(static_cast<const char*>(map), size) : std::string_view(buffer);
+	}
+
+	private:
+
+	void *map = nullptr;
+	size_t size = 0;
+	std::string buffer;
+};
@@ -1,10 +1,14 @@
+#include <algorithm>
+#include <cstring>
 #include "json.hpp"
+#include "parser.hpp"
 
 const JSON::error_category json_error_category;
 
-std::string JSON::json_escape(const std::string &str) {
+std::string JSON::json_escape(std::string_view str) {
 
 	std::string output;
+	output.reserve(str.length());
 
 	for ( unsigned i = 0; i < str.length(); ++i ) {
 
@@ -31,7 +35,12 @@ std::string JSON::json_escape(const std::string &str) {
 				output += "\\t";
 				break;
 			default:
-				output += str[i];
+				if ( (unsigned char)str[i] < 0x20 ) {
+					const char *hex = "0123456789abcdef";
+					output += "\\u00";
+					output += hex[( str[i] >> 4 ) & 0xf];
+					output += hex[str[i] & 0xf];
+				} else output += str[i];
 				break;
 		}
 	}
@@ -39,6 +48,29 @@ std::string JSON::json_escape(const std::string &str) {
 	return output;
 }
 
+// table is emptied when it grows this large, on high-cardinality keys
+static const size_t max_interned_keys = 1 << 16;
+
+const std::string &JSON::KeyTable::intern(std::string_view key) {
+
+	// keys are stored escaped, escape only when there is something to escape
+	if ( std::find_if(key.begin(), key.end(), [](char c) {
+			return c == '\"' || c == '\\' || (unsigned char)c < 0x20; }) != key.end()) {
+		escaped = json_escape(key);
+		key = escaped;
+	}
+
+	if ( auto it = table.find(key); it != table.end())
+		return *it -> second;
+
+	if ( table.size() >= max_interned_keys )
+		clear();
+
+	const std::string &interned = keys.emplace_back(key);
+	table.emplace(interned, &interned);
+	return interned;
+}
+
 std::string JSON::error_category::message(int ev) const {
 
 	switch (static_cast<JSON::error > (ev)) {
@@ -74,209 +106,355 @@ std::string JSON::error_category::message(int ev) const {
 			return "Parsing Null failed: Expected 'null' not found!";
 		case JSON::error::unknown_starting_char:
 			return "Parsing failed: Unknown starting character!";
+		case JSON::error::string_missing_end_quote:
+			return "Parsing String failed: Input ended before closing quote!";
+		case JSON::error::unexpected_end_of_input:
+			return "Parsing failed: Input ended before value was complete!";
+		case JSON::error::depth_limit_exceeded:
+			return "Parsing failed: Nesting depth limit exceeded!";
+		case JSON::error::blank_line:
+			return "Parsing failed: Line is blank!";
 		default:
 			return "Unrecognized error occured...";
 	}
 }
 
-JSON parse_next(const std::string &, size_t &, std::error_code &) noexcept;
-
-void consume_ws(const std::string &str, size_t &offset) {
-	while (isspace(str[offset])) ++offset;
+void consume_ws(std::string_view str, size_t &offset) {
+	while (isspace((unsigned char)char_at(str, offset))) ++offset;
 }
 
-JSON parse_object(const std::string &str, size_t &offset, std::error_code &ec) noexcept {
+static bool parse_hex4(std::string_view str, size_t offset, unsigned &value) noexcept {
 
-	JSON Object = JSON::Make(JSON::Class::Object);
+	value = 0;
 
-	++offset;
-	consume_ws(str, offset);
-	if ( str[offset] == '}' ) {
-		++offset;
-		return Object;
+	for ( unsigned i = 0; i < 4; ++i ) {
+
+		char c = char_at(str, offset + i);
+		value <<= 4;
+
+		if ( c >= '0' && c <= '9' )
+			value |= c - '0';
+		else if ( c >= 'a' && c <= 'f' )
+			value |= c - 'a' + 10;
+		else if ( c >= 'A' && c <= 'F' )
+			value |= c - 'A' + 10;
+		else return false;
 	}
 
-	while (true) {
+	return true;
+}
 
-		JSON Key = parse_next(str, offset, ec);
-		consume_ws(str, offset);
-		if ( str[offset] != ':' ) {
-			ec = JSON::make_error_code(JSON::error::object_missing_colon);
-			break;
-		}
+/*
+ *Output for decoding string in place. Decoded string is never longer than its
+ *escaped form, so writing never passes the position being read.
+ */
+struct insitu_output {
 
-		consume_ws(str, ++offset);
-		JSON Value = parse_next(str, offset, ec);
-		Object[Key.to_string()] = Value;
+	char *data;
+	size_t size = 0;
 
-		consume_ws(str, offset);
-		if ( str[offset] == ',' ) {
-			++offset;
-			continue;
-		} else if ( str[offset] == '}' ) {
-			++offset;
-			break;
-		} else {
-			JSON::make_error_code(JSON::error::object_missing_comma);
-			break;
-		}
+	void clear() {
+		size = 0;
 	}
 
-	return Object;
+	void reserve(size_t) {}
+
+	void append(const char *s, size_t n) {
+		if ( s != data + size )
+			std::memmove(data + size, s, n);
+		size += n;
+	}
+
+	insitu_output &operator+=(char c) {
+		data[size++] = c;
+		return *this;
+	}
+};
+
+template <typename Output>
+static void append_utf8(Output &val, unsigned cp) {
+
+	if ( cp < 0x80 )
+		val += (char)cp;
+	else if ( cp < 0x800 ) {
+		val += (char)( 0xc0 | ( cp >> 6 ));
+		val += (char)( 0x80 | ( cp & 0x3f ));
+	} else if ( cp < 0x10000 ) {
+		val += (char)( 0xe0 | ( cp >> 12 ));
+		val += (char)( 0x80 | (( cp >> 6 ) & 0x3f ));
+		val += (char)( 0x80 | ( cp & 0x3f ));
+	} else {
+		val += (char)( 0xf0 | ( cp >> 18 ));
+		val += (char)( 0x80 | (( cp >> 12 ) & 0x3f ));
+		val += (char)( 0x80 | (( cp >> 6 ) & 0x3f ));
+		val += (char)( 0x80 | ( cp & 0x3f ));
+	}
 }
 
-JSON parse_array(const std::string &str, size_t &offset, std::error_code &ec) noexcept {
+template <typename Output>
+static bool decode_string(std::string_view str, char tick, size_t &offset, Output &val, std::error_code &ec) noexcept {
 
-	JSON Array = JSON::Make(JSON::Class::Array);
-	unsigned index = 0;
+	const char *data = str.data();
+	size_t size = str.size();
+	const char *quote = offset + 1 < size ?
+		static_cast<const char*>(std::memchr(data + offset + 1, tick, size - offset - 1)) : nullptr;
 
-	++offset;
-	consume_ws(str, offset);
-	if ( str[offset] == ']' ) {
-		++offset;
-		return Array;
+	if ( quote == nullptr ) {
+		ec = JSON::make_error_code(JSON::error::string_missing_end_quote);
+		return false;
 	}
 
+	val.clear();
+	val.reserve(quote - data - offset - 1);
+	++offset;
+
 	while (true) {
 
-		Array[index++] = parse_next(str, offset, ec);
-		consume_ws(str, offset);
+		// copy everything up to next escape or closing tick in one go
+		const char *escape = static_cast<const char*>(std::memchr(data + offset, '\\', quote - data - offset));
 
-		if ( str[offset] == ',' ) {
-			++offset;
-			continue;
-		} else if ( str[offset] == ']' ) {
-			++offset;
-			break;
-		} else {
-			JSON::make_error_code(JSON::error::array_missing_comma_or_bracket);
-			return JSON::Make(JSON::Class::Array);
+		if ( escape == nullptr ) {
+			val.append(data + offset, quote - data - offset);
+			offset = quote - data + 1;
+			return true;
+		}
+
+		val.append(data + offset, escape - data - offset);
+		offset = escape - data + 1;
+
+		switch ( char_at(str, offset++)) {
+			case '\'':
+				val += '\'';
+				break;
+			case '\"':
+				val += '\"';
+				break;
+			case '\\':
+				val += '\\';
+				break;
+			case '/':
+				val += '/';
+				break;
+			case 'b':
+				val += '\b';
+				break;
+			case 'f':
+				val += '\f';
+				break;
+			case 'n':
+				val += '\n';
+				break;
+			case 'r':
+				val += '\r';
+				break;
+			case 't':
+				val += '\t';
+				break;
+			case 'u': {
+				unsigned cp, low;
+				if ( !parse_hex4(str, offset, cp)) {
+					ec = JSON::make_error_code(JSON::error::string_missing_hex_char);
+					return false;
+				}
+
+				offset += 4;
+
+				// combine surrogate pair, lone surrogates become replacement character
+				if ( cp >= 0xd800 && cp <= 0xdbff && char_at(str, offset) == '\\' &&
+					char_at(str, offset + 1) == 'u' && parse_hex4(str, offset + 2, low) &&
+					low >= 0xdc00 && low <= 0xdfff ) {
+					cp = 0x10000 + (( cp - 0xd800 ) << 10 ) + ( low - 0xdc00 );
+					offset += 6;
+				} else if ( cp >= 0xd800 && cp <= 0xdfff )
+					cp = 0xfffd;
+
+				append_utf8(val, cp);
+			} break;
+			default:
+				val += '\\';
+				break;
+		}
+
+		// escaped tick was taken as closing tick, look for the real one
+		if ( offset > (size_t)( quote - data )) {
+
+			quote = offset < size ?
+				static_cast<const char*>(std::memchr(data + offset, tick, size - offset)) : nullptr;
+
+			if ( quote == nullptr ) {
+				ec = JSON::make_error_code(JSON::error::string_missing_end_quote);
+				return false;
+			}
 		}
 	}
-	return Array;
 }
 
-JSON parse_string(const std::string &str, char tick, size_t &offset, std::error_code &ec) noexcept {
+bool parse_string(std::string_view str, char tick, size_t &offset, std::string &val, std::error_code &ec) noexcept {
+
+	return decode_string(str, tick, offset, val, ec);
+}
+
+bool parse_string_insitu(char *buf, size_t len, char tick, size_t &offset, std::string_view &val, std::error_code &ec) noexcept {
+
+	insitu_output out { buf + offset + 1 };
+
+	if ( !decode_string(std::string_view(buf, len), tick, offset, out, ec))
+		return false;
+
+	val = std::string_view(out.data, out.size);
+	return true;
+}
+
+JSON parse_string(std::string_view str, char tick, size_t &offset, std::error_code &ec) noexcept {
 
 	std::string val;
-	for ( char c = str[++offset]; c != tick; c = str[++offset] ) {
+	if ( !parse_string(str, tick, offset, val, ec))
+		return JSON::Make(JSON::Class::String);
+	return JSON(std::move(val));
+}
 
-		if ( c == '\\') {
-			switch (str[++offset]) {
-				case '\'':
-					val += '\'';
-					break;
-				case '\"':
-					val += '\"';
-					break;
-				case '\\':
-					val += '\\';
-					break;
-				case '/':
-					val += '/';
-					break;
-				case 'b':
-					val += '\b';
-					break;
-				case 'f':
-					val += '\f';
-					break;
-				case 'n':
-					val += '\n';
-					break;
-				case 'r':
-					val += '\r';
-					break;
-				case 't':
-					val += '\t';
-					break;
-				case 'u': {
-					val += "\\u";
-					for (unsigned i = 1; i <= 4; ++i) {
-						c = str[offset + i];
-						if (( c >= '0' && c <= '9') || ( c >= 'a' && c <= 'f') || ( c >= 'A' && c <= 'F'))
-							val += c;
-						else {
-							JSON::make_error_code(JSON::error::string_missing_hex_char);
-							return JSON::Make(JSON::Class::String);
-						}
-					}
+static inline bool is_digit(char c) noexcept {
+	return c >= '0' && c <= '9';
+}
 
-					offset += 4;
-				} break;
-				default:
-					val += '\\';
-					break;
-			}
-		} else val += c;
+/*
+ *std::from_chars leaves value untouched when number does not fit in a double.
+ *Pick infinity or zero by checking decimal magnitude of the number instead.
+ */
+static double out_of_range_value(const char *first, const char *last) noexcept {
+
+	bool negative = *first == '-';
+	bool fraction = false, significant = false;
+	long long magnitude = 0, exp = 0;
+	const char *p = first + ( negative ? 1 : 0 );
+
+	for ( ; p < last && *p != 'e' && *p != 'E'; ++p ) {
+
+		if ( *p == '.' )
+			fraction = true;
+		else if ( !fraction && ( significant || *p != '0' )) {
+			significant = true;
+			++magnitude;
+		} else if ( fraction && !significant ) {
+			if ( *p == '0' ) --magnitude;
+			else significant = true;
+		}
 	}
-	++offset;
-	return JSON(val);
+
+	if ( p < last ) {
+
+		bool exp_negative = *++p == '-';
+		if ( *p == '-' || *p == '+' ) ++p;
+
+		if ( std::from_chars(p, last, exp).ec == std::errc::result_out_of_range )
+			exp = 1LL << 32;
+
+		magnitude += exp_negative ? -exp : exp;
+	}
+
+	double value = magnitude > 0 ? HUGE_VAL : 0.0;
+	return negative ? -value : value;
 }
 
-JSON parse_number(const std::string &str, size_t &offset, std::error_code &ec) noexcept {
+double JSON::RawFloat(std::string_view text) noexcept {
+
+	const char *first = text.data(), *last = text.data() + text.size();
+	double value = 0.0;
+
+	if ( std::from_chars(first, last, value).ec == std::errc::result_out_of_range )
+		return out_of_range_value(first, last);
+
+	return value;
+}
+
+long long JSON::RawInt(std::string_view text) noexcept {
+
+	long long value = 0;
+	std::from_chars(text.data(), text.data() + text.size(), value);
+	return value;
+}
+
+JSON::Class scan_number(std::string_view str, size_t &offset, std::error_code &ec) noexcept {
 
-	JSON Number;
-	char c;
 	bool isDouble = false;
-	long long exp = 0;
-	std::string val, exp_str;
+	char c;
 
-	while (true) {
+	if ( char_at(str, offset) == '-' )
+		++offset;
 
-		c = str[offset++];
+	// both integer part and fraction, when there is one, need digits
+	size_t digits = offset;
+	while ( is_digit(c = char_at(str, offset))) ++offset;
 
-		if (( c == '-') || ( c >= '0' && c <= '9' ))
-			val += c;
-		else if ( c == '.' ) {
-			val += c;
-			isDouble = true;
-		} else break;
+	if ( offset != digits && c == '.' ) {
+		isDouble = true;
+		digits = ++offset;
+		while ( is_digit(c = char_at(str, offset))) ++offset;
+	}
+
+	if ( offset == digits ) {
+		ec = JSON::make_error_code(JSON::error::number_unexpected_char);
+		return JSON::Class::Null;
 	}
 
 	if ( c == 'E' || c == 'e' ) {
-		c = str[offset];
-		if ( c == '-' ) {
-			++offset;
-			exp_str += '-';
-		}
 
-		if ( c == '+' ) {
-			++offset;
-		}
+		isDouble = true;
+		c = char_at(str, ++offset);
 
-		while (true) {
+		if ( c == '-' || c == '+' )
+			c = char_at(str, ++offset);
 
-			c = str[offset++];
-			if ( c >= '0' && c <= '9' )
-				exp_str += c;
-			else if ( !isspace(c) && c != ',' && c != ']' && c != '}' ) {
-				JSON::make_error_code(JSON::error::number_missing_exponent);
-				return JSON::Make(JSON::Class::Null);
-			} else break;
+		if ( !is_digit(c)) {
+			ec = JSON::make_error_code(JSON::error::number_missing_exponent);
+			return JSON::Class::Null;
 		}
 
-		exp = std::stol(exp_str);
+		while ( is_digit(c = char_at(str, offset))) ++offset;
+	}
 
-	} else if ( !isspace(c) && c != ',' && c != ']' && c != '}' ) {
-		JSON::make_error_code(JSON::error::number_unexpected_char);
+	if ( offset < str.size() && !isspace((unsigned char)c) && c != ',' && c != ']' && c != '}' ) {
+		ec = JSON::make_error_code(JSON::error::number_unexpected_char);
+		return JSON::Class::Null;
+	}
+
+	return isDouble ? JSON::Class::Floating : JSON::Class::Integral;
+}
+
+JSON parse_number(std::string_view str, size_t &offset, std::error_code &ec) noexcept {
+
+	size_t start = offset;
+	JSON::Class type = scan_number(str, offset, ec);
+
+	if ( type == JSON::Class::Null )
 		return JSON::Make(JSON::Class::Null);
+
+	const char *first = str.data() + start;
+	const char *last = str.data() + offset;
+
+	if ( type == JSON::Class::Integral ) {
+
+		long long value;
+		std::from_chars_result result = std::from_chars(first, last, value);
+		if ( result.ec == std::errc() && result.ptr == last )
+			return JSON(value);
 	}
 
-	--offset;
+	// anything left unconverted means scan_number and from_chars disagree, fail instead of truncating
+	double value;
+	std::from_chars_result result = std::from_chars(first, last, value);
 
-	if ( isDouble )
-		Number = std::stod(val) *std::pow(10, exp);
-	else {
-		if ( !exp_str.empty())
-			Number = std::stol(val) * std::pow(10, exp);
-		else
-			Number = std::stol(val);
-		}
-	return Number;
+	if ( result.ec == std::errc::result_out_of_range )
+		return JSON(out_of_range_value(first, last));
+	else if ( result.ec != std::errc() || result.ptr != last ) {
+		ec = JSON::make_error_code(JSON::error::number_conversion_failed);
+		return JSON::Make(JSON::Class::Null);
+	}
+
+	return JSON(value);
 }
 
-JSON parse_bool(const std::string &str, size_t &offset, std::error_code &ec) noexcept {
+JSON parse_bool(std::string_view str, size_t &offset, std::error_code &ec) noexcept {
 
 	JSON Bool;
 
@@ -285,64 +463,342 @@ JSON parse_bool(const std::string &str, size_t &offset, std::error_code &ec) noe
 	else if ( str.substr(offset, 5) == "false" )
 		Bool = false;
 	else {
-		JSON::make_error_code(JSON::error::bool_wrong_text);
+		ec = JSON::make_error_code(JSON::error::bool_wrong_text);
 		return JSON::Make(JSON::Class::Null);
 	}
 	offset += (Bool.to_bool() ? 4 : 5);
 	return Bool;
 }
 
-JSON parse_null(const std::string &str, size_t &offset, std::error_code &ec) noexcept {
+JSON parse_null(std::string_view str, size_t &offset, std::error_code &ec) noexcept {
 
 	if ( str.substr(offset, 4) != "null" ) {
-		JSON::make_error_code(JSON::error::null_wrong_text);
+		ec = JSON::make_error_code(JSON::error::null_wrong_text);
 		return JSON::Make(JSON::Class::Null);
 	}
 	offset += str.substr(offset, 7) == "nullptr" ? 7 : 4;
 	return JSON();
 }
 
-JSON parse_next(const std::string &str, size_t &offset, std::error_code &ec) noexcept {
-
-	char value;
-	consume_ws(str, offset);
-	value = str[offset];
-
-	switch (value) {
-		case '[':
-			return parse_array(str, offset, ec);
-		case '{':
-			return parse_object(str, offset, ec);
-		case '\"':
-			return parse_string(str, '\"', offset, ec);
-		case '\'':
-			return parse_string(str, '\'', offset, ec);
-		case 't':
-		case 'f':
-			return parse_bool(str, offset, ec);
-		case 'n':
-			return parse_null(str, offset, ec);
-		default:
-			if (( value <= '9' && value >= '0') || value == '-' )
-				return parse_number(str, offset, ec);
+/*
+ *Frees container and everything in it. Nested containers are first moved out to
+ *a worklist, so deleting a container never recurses, no matter how deep the tree is.
+ *Nested containers shared with other values only lose a reference.
+ */
+void JSON::ClearTree() noexcept {
+
+	std::vector<JSON> pending;
+	JSON node;
+
+	auto take = [&pending](JSON &child) {
+
+		if ( child.Type != Class::Array && child.Type != Class::Object )
+			return;
+		else if ( child.Release())
+			pending.push_back(std::move(child));
+		else child.Type = Class::Null;
+	};
+
+	node.Internal = Internal;
+	node.Small = Small;
+	node.Type = Type;
+	Type = Class::Null;
+	Small = 0;
+
+	while (true) {
+
+		if ( node.Packed() != Packing::None )
+			node.VisitPacked([](auto *p) { Destroy(p); });
+		else if ( node.Type == Class::Array ) {
+			for ( auto &child : *node.Internal.List )
+				take(child);
+			Destroy(node.Internal.List);
+		} else {
+			for ( auto &child : *node.Internal.Map )
+				take(child.second);
+			Destroy(node.Internal.Map);
+		}
+
+		node.Type = Class::Null;
+		node.Small = 0;
+
+		if ( pending.empty())
+			break;
+
+		node.Internal = pending.back().Internal;
+		node.Small = pending.back().Small;
+		node.Type = pending.back().Type;
+		pending.back().Type = Class::Null;
+		pending.back().Small = 0;
+		pending.pop_back();
 	}
+}
 
-	JSON::make_error_code(JSON::error::unknown_starting_char);
-	return JSON();
+/*
+ *Containers that can not be shared are left Null in their parent at first and
+ *copied when they are taken from the worklist, like ClearTree frees them.
+ */
+JSON JSON::CopyTree() const {
+
+	std::vector<std::pair<const JSON*, JSON*>> pending;
+	JSON copy;
+
+	auto deep = [](const JSON &value) {
+		return ( value.Type == Class::Array || value.Type == Class::Object ) && !value.Shareable();
+	};
+
+	pending.emplace_back(this, &copy);
+
+	while ( !pending.empty()) {
+
+		auto [from, to] = pending.back();
+		pending.pop_back();
+
+		if ( from -> Packed() != Packing::None ) {
+			*to = from -> CopyStorage();
+			continue;
+		}
+
+		if ( from -> Type == Class::Array ) {
+
+			const ArrayStorage &list = *from -> Internal.List;
+
+			to -> Adopt(Create<ArrayStorage>(nullptr));
+			to -> Internal.List -> reserve(list.size());
+
+			for ( const JSON &child : list )
+				to -> Internal.List -> push_back(deep(child) ? JSON() : child);
+
+			for ( std::size_t i = 0; i < list.size(); ++i )
+				if ( deep(list[i]))
+					pending.emplace_back(&list[i], &( *to -> Internal.List )[i]);
+
+		} else {
+
+			const ObjectStorage &map = *from -> Internal.Map;
+
+			to -> Adopt(Create<ObjectStorage>(nullptr, map.layout()));
+			to -> Internal.Map -> entries.reserve(map.size());
+			to -> Internal.Map -> index.assign(map.index.begin(), map.index.end());
+
+			for ( const auto &entry : map )
+				to -> Internal.Map -> entries.emplace_back(entry.first, deep(entry.second) ? JSON() : entry.second);
+
+			for ( std::size_t i = 0; i < map.size(); ++i )
+				if ( deep(map.entries[i].second))
+					pending.emplace_back(&map.entries[i].second, &to -> Internal.Map -> entries[i].second);
+		}
+	}
+
+	return copy;
+}
+
+void JSON::Write(std::string &s, int depth, std::string_view tab, bool minified) const {
+
+	struct Frame {
+		const JSON *value;
+		std::size_t next;
+		int depth;
+	};
+
+	std::vector<Frame> stack;
+
+	auto indent = [&s, tab](int depth) {
+		for ( int i = 0; i < depth; ++i )
+			s += tab;
+	};
+
+	// writes scalars and packed arrays, opens other containers
+	auto write = [&s, &stack, minified](const JSON &value, int depth) {
+
+		switch ( value.Type ) {
+			case Class::Null:
+				s += "null";
+				break;
+			case Class::Object:
+				s += minified ? "{" : "{\n";
+				stack.push_back({ &value, 0, depth });
+				break;
+			case Class::Array:
+				s += "[";
+				if ( value.Packed() == Packing::None ) {
+					stack.push_back({ &value, 0, depth });
+					break;
+				}
+				value.VisitPacked([&s, minified](auto *p) {
+					for ( std::size_t i = 0; i < p -> size(); ++i ) {
+						if ( i != 0 ) s += minified ? "," : ", ";
+						s += std::to_string(( *p )[i]);
+					}
+				});
+				s += "]";
+				break;
+			case Class::String:
+				s += "\"";
+				s += json_escape(value.StringView());
+				s += "\"";
+				break;
+			case Class::Floating:
+				s += value.Raw() ? std::string(value.RawText()) : std::to_string(value.Internal.Float);
+				break;
+			case Class::Integral:
+				s += value.Raw() ? std::string(value.RawText()) : std::to_string(value.Internal.Int);
+				break;
+			case Class::Boolean:
+				s += value.Internal.Bool ? "true" : "false";
+				break;
+		}
+	};
+
+	write(*this, depth);
+
+	while ( !stack.empty()) {
+
+		auto [value, i, level] = stack.back();
+		bool object = value -> Type == Class::Object;
+
+		if ( i == ( object ? value -> Internal.Map -> size() : value -> Internal.List -> size())) {
+
+			if ( object && !minified ) {
+				s += "\n";
+				indent(level - 1);
+			}
+
+			s += object ? "}" : "]";
+			stack.pop_back();
+			continue;
+		}
+
+		++stack.back().next;
+
+		if ( object ) {
+
+			const auto &entry = value -> Internal.Map -> entries[i];
+
+			if ( i != 0 ) s += minified ? "," : ",\n";
+			if ( !minified ) indent(level);
+
+			s += "\"";
+			s += std::string_view(entry.first);
+			s += minified ? "\":" : "\" : ";
+			write(entry.second, level + 1);
+
+		} else {
+
+			if ( i != 0 ) s += minified ? "," : ", ";
+			write(( *value -> Internal.List )[i], level + 1);
+		}
+	}
+}
+
+JSON load_interned(std::string_view str, tree_builder::key_table &keys, const JSON::ParseOptions &options, std::error_code &ec) noexcept {
+
+	tree_builder builder(keys);
+	event_parser<tree_builder> parser(str, builder, ec);
+
+	builder.resource = options.resource;
+	builder.layout = options.object_layout;
+	builder.pack = options.pack_arrays;
+	builder.lazy_numbers = options.lazy_numbers;
+	parser.max_depth = options.max_depth;
+	parser.value();
+	return builder.finish();
 }
 
-JSON JSON::Load(const std::string &str, std::error_code &ec) noexcept {
+JSON JSON::Load(std::string_view str, const JSON::ParseOptions &options, std::error_code &ec) noexcept {
 
-	size_t offset = 0;
-	return parse_next(str, offset, ec);
+	JSON::KeyTable keys;
+	return load_interned(str, keys, options, ec);
 }
 
-JSON JSON::Load(const std::string &str) {
+JSON JSON::Load(std::string_view str, const JSON::ParseOptions &options) {
 
-	size_t offset = 0;
 	std::error_code ec;
-	if ( JSON obj = parse_next(str, offset, ec); !ec )
+	if ( JSON obj = JSON::Load(str, options, ec); !ec )
 		return obj;
 	else throw std::runtime_error(ec.message());
 }
 
+JSON JSON::LoadInSitu(char *buf, size_t len, const JSON::ParseOptions &options, std::error_code &ec) noexcept {
+
+	std::string_view str(buf, buf == nullptr ? 0 : len);
+	JSON::KeyTable keys;
+	tree_builder builder(keys);
+	event_parser<tree_builder> parser(str, builder, ec);
+
+	builder.resource = options.resource;
+	builder.layout = options.object_layout;
+	builder.pack = options.pack_arrays;
+	builder.lazy_numbers = options.lazy_numbers;
+	parser.max_depth = options.max_depth;
+	parser.insitu = buf;
+	parser.value();
+	return builder.finish();
+}
+
+JSON JSON::LoadInSitu(char *buf, size_t len, const JSON::ParseOptions &options) {
+
+	std::error_code ec;
+	if ( JSON obj = JSON::LoadInSitu(buf, len, options, ec); !ec )
+		return obj;
+	else throw std::runtime_error(ec.message());
+}
+
+JSON JSON::LoadInSitu(char *buf, size_t len, std::error_code &ec) noexcept {
+
+	return JSON::LoadInSitu(buf, len, JSON::ParseOptions(), ec);
+}
+
+JSON JSON::LoadInSitu(char *buf, size_t len) {
+
+	return JSON::LoadInSitu(buf, len, JSON::ParseOptions());
+}
+
+JSON JSON::Load(std::string_view str, std::error_code &ec) noexcept {
+
+	return JSON::Load(str, JSON::ParseOptions(), ec);
+}
+
+JSON JSON::Load(std::string_view str) {
+
+	std::error_code ec;
+	if ( JSON obj = JSON::Load(str, ec); !ec )
+		return obj;
+	else throw std::runtime_error(ec.message());
+}
+
+JSON JSON::Load(const char *data, size_t len, std::error_code &ec) noexcept {
+
+	return JSON::Load(std::string_view(data, data == nullptr ? 0 : len), ec);
+}
+
+JSON JSON::Load(const char *data, size_t len) {
+
+	return JSON::Load(std::string_view(data, data == nullptr ? 0 : len));
+}
+
+
+bool JSON::Parse(std::string_view str, JSON::Handler &handler, const JSON::ParseOptions &options, std::error_code &ec) {
+
+	event_parser<JSON::Handler> parser(str, handler, ec);
+	parser.max_depth = options.max_depth;
+	return parser.value() && !ec;
+}
+
+bool JSON::Parse(std::string_view str, JSON::Handler &handler, const JSON::ParseOptions &options) {
+
+	std::error_code ec;
+	if ( bool ret = JSON::Parse(str, handler, options, ec); !ec )
+		return ret;
+	else throw std::runtime_error(ec.message());
+}
+
+bool JSON::Parse(std::string_view str, JSON::Handler &handler, std::error_code &ec) {
+
+	return JSON::Parse(str, handler, JSON::ParseOptions(), ec);
+}
+
+bool JSON::Parse(std::string_view str, JSON::Handler &handler) {
+
+	return JSON::Parse(str, handler, JSON::ParseOptions());
+}
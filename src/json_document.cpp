@@ -0,0 +1,142 @@
+#include "json.hpp"
+#include "parser.hpp"
+
+/*
+ *Takes tree apart into pools instead of freeing it. Works through a worklist,
+ *like ClearTree, so deep trees do not recurse.
+ */
+void JSON::Document::recycle(JSON &root) {
+
+	auto take = [this](JSON &node) {
+
+		// containers still shared with copies of the tree are left to them
+		if ( node.Type == Class::Array || node.Type == Class::Object ) {
+			if ( node.Release())
+				pending.push_back(std::move(node));
+			else node.Type = Class::Null;
+		}
+		else if ( node.Type == Class::String && node.Small == 0 && node.Slice == 0 ) {
+			strings.push_back(node.Internal.String);
+			node.Type = Class::Null;
+		}
+	};
+
+	take(root);
+
+	while ( !pending.empty()) {
+
+		JSON node = std::move(pending.back());
+		pending.pop_back();
+
+		if ( node.Packed() == Packing::Floating ) {
+
+			node.Internal.Floats -> DropNodes();
+			node.Internal.Floats -> clear();
+			floats.push_back(node.Internal.Floats);
+
+		} else if ( node.Packed() == Packing::Integral ) {
+
+			node.Internal.Ints -> DropNodes();
+			node.Internal.Ints -> clear();
+			ints.push_back(node.Internal.Ints);
+
+		} else if ( node.Type == Class::Array ) {
+
+			for ( auto &child : *node.Internal.List )
+				take(child);
+
+			node.Internal.List -> clear();
+			node.Internal.List -> leaked = false;
+			lists.push_back(node.Internal.List);
+
+		} else {
+
+			for ( auto &entry : *node.Internal.Map )
+				take(entry.second);
+
+			node.Internal.Map -> reset(options.object_layout);
+			maps.push_back(node.Internal.Map);
+		}
+
+		node.Type = Class::Null;
+		node.Small = 0;
+	}
+
+	root = JSON();
+}
+
+JSON &JSON::Document::load_into(std::string_view str, std::error_code &ec) noexcept {
+
+	recycle(value);
+
+	tree_builder builder(keys);
+	event_parser<tree_builder> parser(str, builder, ec);
+
+	builder.doc = this;
+	builder.resource = options.resource;
+	builder.layout = options.object_layout;
+	builder.pack = options.pack_arrays;
+	builder.lazy_numbers = options.lazy_numbers;
+	builder.stack.swap(stack);
+	builder.keys.swap(stack_keys);
+	builder.elements.swap(elements);
+	builder.starts.swap(starts);
+	parser.stack.swap(nesting);
+	parser.buffer.swap(buffer);
+	parser.max_depth = options.max_depth;
+
+	parser.value();
+	parser.stack.clear();
+	value = builder.finish();
+
+	builder.stack.swap(stack);
+	builder.keys.swap(stack_keys);
+	builder.elements.swap(elements);
+	builder.starts.swap(starts);
+	parser.stack.swap(nesting);
+	parser.buffer.swap(buffer);
+
+	return value;
+}
+
+JSON &JSON::Document::load_into(std::string_view str) {
+
+	std::error_code ec;
+	if ( JSON &obj = load_into(str, ec); !ec )
+		return obj;
+	else throw std::runtime_error(ec.message());
+}
+
+void JSON::Document::clear() {
+
+	recycle(value);
+
+	for ( auto list : lists )
+		Destroy(list);
+
+	for ( auto map : maps )
+		Destroy(map);
+
+	for ( auto str : strings )
+		Destroy(str);
+
+	for ( auto list : floats )
+		Destroy(list);
+
+	for ( auto list : ints )
+		Destroy(list);
+
+	std::vector<ArrayStorage*>().swap(lists);
+	std::vector<Map*>().swap(maps);
+	std::vector<StringStorage*>().swap(strings);
+	std::vector<PackedStorage<double>*>().swap(floats);
+	std::vector<PackedStorage<long long>*>().swap(ints);
+	std::vector<JSON>().swap(stack);
+	std::vector<std::string>().swap(stack_keys);
+	std::vector<JSON>().swap(elements);
+	std::vector<size_t>().swap(starts);
+	std::vector<bool>().swap(nesting);
+	std::vector<JSON>().swap(pending);
+	std::string().swap(buffer);
+	keys.clear();
+}
@@ -0,0 +1,128 @@
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define JSON_FILE_MMAP
+#endif
+
+#include <cerrno>
+#include <cstdio>
+#include <new>
+#include "json.hpp"
+#include "file.hpp"
+
+#ifdef JSON_FILE_MMAP
+
+mapped_file::mapped_file(const std::string &path, std::error_code &ec) noexcept {
+
+	int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+	if ( fd < 0 ) {
+		ec = std::error_code(errno, std::generic_category());
+		return;
+	}
+
+	struct stat st;
+
+	if ( ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 ) {
+
+		void *addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if ( addr != MAP_FAILED ) {
+			::madvise(addr, st.st_size, MADV_SEQUENTIAL);
+			map = addr;
+			size = st.st_size;
+			::close(fd);
+			return;
+		}
+	}
+
+	// not mappable, read it in
+	char chunk[65536];
+	ssize_t len;
+
+	try {
+		while (( len = ::read(fd, chunk, sizeof(chunk))) != 0 ) {
+
+			if ( len < 0 ) {
+				if ( errno == EINTR )
+					continue;
+				ec = std::error_code(errno, std::generic_category());
+				break;
+			}
+
+			buffer.append(chunk, len);
+		}
+	} catch (const std::bad_alloc &) {
+		ec = std::make_error_code(std::errc::not_enough_memory);
+	}
+
+	::close(fd);
+}
+
+mapped_file::~mapped_file() {
+
+	if ( map )
+		::munmap(map, size);
+}
+
+#else
+
+mapped_file::mapped_file(const std::string &path, std::error_code &ec) noexcept {
+
+	std::FILE *file = std::fopen(path.c_str(), "rb");
+
+	if ( file == nullptr ) {
+		ec = std::error_code(errno, std::generic_category());
+		return;
+	}
+
+	// no mmap on this platform, always read it in
+	char chunk[65536];
+	size_t len;
+
+	try {
+		while (( len = std::fread(chunk, 1, sizeof(chunk), file)) != 0 )
+			buffer.append(chunk, len);
+	} catch (const std::bad_alloc &) {
+		ec = std::make_error_code(std::errc::not_enough_memory);
+	}
+
+	if ( !ec && std::ferror(file))
+		ec = std::make_error_code(std::errc::io_error);
+
+	std::fclose(file);
+}
+
+mapped_file::~mapped_file() {}
+
+#endif
+
+JSON JSON::LoadFile(const std::string &path, const JSON::ParseOptions &options, std::error_code &ec) noexcept {
+
+	mapped_file file(path, ec);
+
+	if ( ec )
+		return JSON();
+
+	return JSON::Load(file.data(), options, ec);
+}
+
+JSON JSON::LoadFile(const std::string &path, const JSON::ParseOptions &options) {
+
+	std::error_code ec;
+	if ( JSON obj = JSON::LoadFile(path, options, ec); !ec )
+		return obj;
+	else throw std::runtime_error(ec.message());
+}
+
+JSON JSON::LoadFile(const std::string &path, std::error_code &ec) noexcept {
+
+	return JSON::LoadFile(path, JSON::ParseOptions(), ec);
+}
+
+JSON JSON::LoadFile(const std::string &path) {
+
+	return JSON::LoadFile(path, JSON::ParseOptions());
+}
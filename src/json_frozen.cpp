@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <numeric>
+#include "json.hpp"
+#include "parser.hpp"
+
+/*
+ *Tree is copied through a worklist, like ClearTree, so deep trees do not recurse.
+ *Each container gets its children placed next to each other when it is taken from it.
+ */
+JSON::Frozen JSON::freeze() const {
+
+	auto data = std::make_shared<FrozenView::Storage>();
+	std::vector<std::pair<const JSON*, std::uint32_t>> pending;
+	std::unordered_map<std::string_view, std::uint32_t> keys;
+	std::vector<std::uint32_t> bucket, order, size, slots;
+	std::vector<bool> taken;
+
+	auto hash = [&data](std::uint32_t first, std::uint32_t member) {
+		return data -> keys[data -> nodes[first + member].key].hash;
+	};
+
+	/*
+	 *Fallback for objects perfect_hash gives up on: members are placed in order of
+	 *their buckets to the first free slot from their bucket, and seed of each bucket
+	 *tells how many slots from it its members spread to.
+	 */
+	auto probed_hash = [&](std::uint32_t first, std::uint32_t n) {
+
+		std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+			return bucket[a] != bucket[b] ? bucket[a] < bucket[b] : a < b;
+		});
+
+		taken.assign(n, false);
+		size.assign(n, 0); // span of bucket
+
+		for ( std::uint32_t member : order ) {
+
+			std::uint32_t b = bucket[member], slot = b, span = 1;
+
+			for ( ; taken[slot]; ++span )
+				slot = slot + 1 == n ? 0 : slot + 1;
+
+			taken[slot] = true;
+			data -> slots[first + slot].member = member;
+			size[b] = std::max(size[b], span);
+		}
+
+		for ( std::uint32_t b = 0; b < n; ++b )
+			data -> slots[first + b].seed = FrozenView::Probed + size[b];
+	};
+
+	/*
+	 *Builds minimal perfect hash of n members of object starting at first, hash and
+	 *displace: keys are grouped to buckets by hash, and largest buckets are placed
+	 *first, searching for a seed that moves all their keys to free slots. Buckets
+	 *with keys of same hash, or no seed found within MaxSeed tries, make the whole
+	 *object fall back to probed_hash.
+	 */
+	auto perfect_hash = [&](std::uint32_t first, std::uint32_t n) {
+
+		bucket.resize(n);
+		order.resize(n);
+		size.assign(n, 0);
+		taken.assign(n, false);
+
+		for ( std::uint32_t i = 0; i < n; ++i ) {
+			bucket[i] = FrozenView::Reduce(hash(first, i), 0, n);
+			data -> slots[first + i].seed = 0;
+			++size[bucket[i]];
+		}
+
+		// members ordered by bucket, largest buckets first
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+			return size[bucket[a]] != size[bucket[b]] ? size[bucket[a]] > size[bucket[b]] :
+				bucket[a] != bucket[b] ? bucket[a] < bucket[b] : hash(first, a) < hash(first, b);
+		});
+
+		for ( std::uint32_t i = 0; i < n; ) {
+
+			std::uint32_t b = bucket[order[i]], count = size[b], seed = 1;
+
+			// no seed separates keys of same hash, they are next to each other within bucket
+			for ( std::uint32_t j = 1; j < count; ++j )
+				if ( hash(first, order[i + j]) == hash(first, order[i + j - 1]))
+					return probed_hash(first, n);
+
+			for ( ; seed <= FrozenView::MaxSeed; ++seed ) {
+
+				slots.clear();
+
+				for ( std::uint32_t j = 0; j < count; ++j ) {
+
+					std::uint32_t slot = FrozenView::Reduce(hash(first, order[i + j]), seed, n);
+
+					if ( taken[slot] || std::find(slots.begin(), slots.end(), slot) != slots.end())
+						break;
+
+					slots.push_back(slot);
+				}
+
+				if ( slots.size() == count )
+					break;
+			}
+
+			if ( seed > FrozenView::MaxSeed )
+				return probed_hash(first, n);
+
+			for ( std::uint32_t j = 0; j < count; ++j ) {
+				taken[slots[j]] = true;
+				data -> slots[first + slots[j]].member = order[i + j];
+			}
+
+			data -> slots[first + b].seed = seed;
+			i += count;
+		}
+	};
+
+	auto text = [&data](std::string_view str) {
+
+		if ( str.size() > UINT32_MAX - data -> text.size())
+			throw std::length_error("JSON::freeze: document too large");
+
+		FrozenView::Range range { (std::uint32_t)data -> text.size(), (std::uint32_t)str.size() };
+		data -> text.append(str);
+		return range;
+	};
+
+	auto reserve = [&data](std::size_t n) {
+
+		std::size_t first = data -> nodes.size();
+
+		if ( n > UINT32_MAX - first )
+			throw std::length_error("JSON::freeze: document too large");
+
+		data -> nodes.resize(first + n, FrozenView::Node { {}, FrozenView::NoKey, Class::Null });
+		data -> slots.resize(first + n);
+		return (std::uint32_t)first;
+	};
+
+	auto convert = [&pending, &text](const JSON &value, FrozenView::Node &node, std::uint32_t index) {
+
+		node.type = value.Type;
+
+		switch ( value.Type ) {
+			case Class::Floating:
+				node.Float = value.FloatValue();
+				break;
+			case Class::Integral:
+				node.Int = value.IntValue();
+				break;
+			case Class::Boolean:
+				node.Bool = value.Internal.Bool;
+				break;
+			case Class::String:
+				node.Extent = text(value.StringView());
+				break;
+			case Class::Array:
+			case Class::Object:
+				pending.emplace_back(&value, index);
+				break;
+			default: ;
+		}
+	};
+
+	convert(*this, data -> nodes[reserve(1)], 0);
+
+	while ( !pending.empty()) {
+
+		auto [value, index] = pending.back();
+		pending.pop_back();
+
+		std::uint32_t first = reserve(value -> Type == Class::Object ? value -> Internal.Map -> size() :
+							value -> Visit([](auto *p) { return p -> size(); }));
+		FrozenView::Node *children = data -> nodes.data() + first;
+
+		data -> nodes[index].Extent = { first, (std::uint32_t)( data -> nodes.size() - first ) };
+
+		if ( value -> Packed() != Packing::None ) {
+
+			value -> VisitPacked([children](auto *p) {
+				for ( std::size_t i = 0; i < p -> size(); ++i ) {
+					if constexpr ( std::is_same<typename std::remove_pointer_t<decltype(p)>::value_type, double>::value ) {
+						children[i].Float = ( *p )[i];
+						children[i].type = Class::Floating;
+					} else {
+						children[i].Int = ( *p )[i];
+						children[i].type = Class::Integral;
+					}
+				}
+			});
+
+		} else if ( value -> Type == Class::Array ) {
+
+			for ( std::uint32_t i = 0; i < value -> Internal.List -> size(); ++i )
+				convert(( *value -> Internal.List )[i], children[i], first + i);
+
+		} else {
+
+			std::uint32_t i = 0;
+
+			for ( const auto &entry : *value -> Internal.Map ) {
+
+				auto [it, added] = keys.try_emplace(entry.first, (std::uint32_t)data -> keys.size());
+
+				if ( added )
+					data -> keys.push_back({ text(entry.first), std::hash<std::string_view>()(entry.first) });
+
+				children[i].key = it -> second;
+				convert(entry.second, children[i], first + i);
+				++i;
+			}
+
+			if ( i != 0 )
+				perfect_hash(first, i);
+		}
+	}
+
+	Frozen result;
+	result.storage = std::move(data);
+	return result;
+}
+
+/*
+ *Walks viewed value with an explicit stack, reporting it to tree_builder
+ *like parser would. Keys are frozen as they were stored, escaped, so they
+ *are given to builder directly instead of interning them through its table.
+ */
+JSON JSON::FrozenView::thaw() const {
+
+	if ( node == nullptr )
+		return JSON();
+
+	JSON::KeyTable table;
+	tree_builder builder(table);
+	std::vector<std::pair<const Node*, std::uint32_t>> stack;
+	std::string buffer;
+
+	builder.pack = ParseOptions().pack_arrays;
+
+	auto emit = [this, &builder, &stack, &buffer](const Node *value) {
+
+		switch ( value -> type ) {
+			case Class::Floating:
+				builder.floating(value -> Float);
+				break;
+			case Class::Integral:
+				builder.integral(value -> Int);
+				break;
+			case Class::Boolean:
+				builder.boolean(value -> Bool);
+				break;
+			case Class::String:
+				buffer = Text(value -> Extent);
+				builder.string(buffer);
+				break;
+			case Class::Array:
+				builder.start_array();
+				stack.emplace_back(value, 0);
+				break;
+			case Class::Object:
+				builder.start_object();
+				stack.emplace_back(value, 0);
+				break;
+			default:
+				builder.null();
+		}
+	};
+
+	emit(node);
+
+	while ( !stack.empty()) {
+
+		auto [value, i] = stack.back();
+
+		if ( i == value -> Extent.count ) {
+
+			if ( value -> type == Class::Object )
+				builder.end_object();
+			else builder.end_array();
+
+			stack.pop_back();
+			continue;
+		}
+
+		const Node *child = data -> nodes.data() + value -> Extent.first + i;
+		++stack.back().second;
+
+		if ( value -> type == Class::Object )
+			builder.keys.back() = Text(data -> keys[child -> key].chars);
+
+		emit(child);
+	}
+
+	return builder.finish();
+}
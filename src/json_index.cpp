@@ -0,0 +1,501 @@
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include "json.hpp"
+#include "parser.hpp"
+
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define JSON_INDEX_X86
+#endif
+
+/*
+ *Two-stage parser. First stage classifies input in blocks of 64 bytes and writes
+ *offsets of structural characters, string openings and scalar starts into an index.
+ *Second stage builds the tree by walking the index without recursion, using the
+ *same value parsers and tree builder as Load, so results and errors are identical
+ *to it. Input that can not be indexed is parsed with Load's parser instead.
+ */
+
+struct block_masks {
+	uint64_t quote;
+	uint64_t tick;
+	uint64_t backslash;
+	uint64_t op;
+	uint64_t ws;
+};
+
+typedef void (*classify_fn)(const char *, block_masks &);
+
+static void classify_scalar(const char *p, block_masks &m) noexcept {
+
+	m = {};
+
+	for ( unsigned i = 0; i < 64; ++i ) {
+
+		uint64_t bit = 1ULL << i;
+
+		switch ( p[i] ) {
+			case '\"':
+				m.quote |= bit;
+				break;
+			case '\'':
+				m.tick |= bit;
+				break;
+			case '\\':
+				m.backslash |= bit;
+				break;
+			case '{': case '}': case '[': case ']': case ':': case ',':
+				m.op |= bit;
+				break;
+			case ' ': case '\t': case '\n': case '\v': case '\f': case '\r':
+				m.ws |= bit;
+				break;
+			default: ;
+		}
+	}
+}
+
+#ifdef JSON_INDEX_X86
+
+__attribute__((target("sse2")))
+static inline __m128i eq128(__m128i v, char c) {
+	return _mm_cmpeq_epi8(v, _mm_set1_epi8(c));
+}
+
+__attribute__((target("sse2")))
+static void classify_sse2(const char *p, block_masks &m) noexcept {
+
+	m = {};
+
+	for ( unsigned i = 0; i < 4; ++i ) {
+
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i * 16));
+		__m128i op = _mm_or_si128(_mm_or_si128(_mm_or_si128(eq128(v, '{'), eq128(v, '}')),
+				_mm_or_si128(eq128(v, '['), eq128(v, ']'))), _mm_or_si128(eq128(v, ':'), eq128(v, ',')));
+
+		// '\t' .. '\r' are a continuous range, v - '\t' <= 4 as unsigned
+		__m128i d = _mm_sub_epi8(v, _mm_set1_epi8('\t'));
+		__m128i ws = _mm_or_si128(eq128(v, ' '), _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(4)), d));
+		unsigned shift = i * 16;
+
+		m.quote |= (uint64_t)(uint16_t)_mm_movemask_epi8(eq128(v, '\"')) << shift;
+		m.tick |= (uint64_t)(uint16_t)_mm_movemask_epi8(eq128(v, '\'')) << shift;
+		m.backslash |= (uint64_t)(uint16_t)_mm_movemask_epi8(eq128(v, '\\')) << shift;
+		m.op |= (uint64_t)(uint16_t)_mm_movemask_epi8(op) << shift;
+		m.ws |= (uint64_t)(uint16_t)_mm_movemask_epi8(ws) << shift;
+	}
+}
+
+__attribute__((target("avx2")))
+static inline __m256i eq256(__m256i v, char c) {
+	return _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c));
+}
+
+__attribute__((target("avx2")))
+static void classify_avx2(const char *p, block_masks &m) noexcept {
+
+	m = {};
+
+	for ( unsigned i = 0; i < 2; ++i ) {
+
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i * 32));
+		__m256i op = _mm256_or_si256(_mm256_or_si256(_mm256_or_si256(eq256(v, '{'), eq256(v, '}')),
+				_mm256_or_si256(eq256(v, '['), eq256(v, ']'))), _mm256_or_si256(eq256(v, ':'), eq256(v, ',')));
+
+		__m256i d = _mm256_sub_epi8(v, _mm256_set1_epi8('\t'));
+		__m256i ws = _mm256_or_si256(eq256(v, ' '), _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(4)), d));
+		unsigned shift = i * 32;
+
+		m.quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(eq256(v, '\"')) << shift;
+		m.tick |= (uint64_t)(uint32_t)_mm256_movemask_epi8(eq256(v, '\'')) << shift;
+		m.backslash |= (uint64_t)(uint32_t)_mm256_movemask_epi8(eq256(v, '\\')) << shift;
+		m.op |= (uint64_t)(uint32_t)_mm256_movemask_epi8(op) << shift;
+		m.ws |= (uint64_t)(uint32_t)_mm256_movemask_epi8(ws) << shift;
+	}
+}
+
+#endif
+
+static classify_fn select_classifier() noexcept {
+
+#ifdef JSON_INDEX_X86
+	__builtin_cpu_init();
+	if ( __builtin_cpu_supports("avx2"))
+		return classify_avx2;
+	if ( __builtin_cpu_supports("sse2"))
+		return classify_sse2;
+#endif
+	return classify_scalar;
+}
+
+static inline unsigned trailing_zeros(uint64_t x) noexcept {
+
+#ifdef __GNUC__
+	return __builtin_ctzll(x);
+#else
+	unsigned n = 0;
+	for ( ; !( x & 1 ); x >>= 1, ++n );
+	return n;
+#endif
+}
+
+/*
+ *Returns mask of characters escaped by a backslash. Backslashes are rare,
+ *so they are walked one by one. carry tells if first byte of next block is escaped.
+ */
+static inline uint64_t find_escaped(uint64_t backslash, uint64_t &carry) noexcept {
+
+	uint64_t escaped = carry;
+	carry = 0;
+
+	while ( backslash ) {
+
+		unsigned i = trailing_zeros(backslash);
+		backslash &= backslash - 1;
+
+		if ( escaped & ( 1ULL << i ))
+			continue;
+		else if ( i == 63 )
+			carry = 1;
+		else escaped |= 1ULL << ( i + 1 );
+	}
+
+	return escaped;
+}
+
+static inline uint64_t prefix_xor(uint64_t x) noexcept {
+
+	x ^= x << 1;
+	x ^= x << 2;
+	x ^= x << 4;
+	x ^= x << 8;
+	x ^= x << 16;
+	x ^= x << 32;
+	return x;
+}
+
+/*
+ *Stage 1. Returns false if input can not be indexed: it is too large or contains
+ *single ticked strings. A string left open is indexed up to its opening quote,
+ *stage 2 reports it.
+ */
+static bool build_index(std::string_view str, std::vector<uint32_t> &index) {
+
+	static const classify_fn classify = select_classifier();
+
+	if ( str.size() >= UINT32_MAX )
+		return false;
+
+	uint64_t prev_in_string = 0, prev_escaped = 0, prev_scalar = 0;
+	char tail[64];
+
+	index.reserve(str.size() / 4 + 1);
+
+	for ( size_t base = 0; base < str.size(); base += 64 ) {
+
+		const char *p = str.data() + base;
+
+		if ( str.size() - base < 64 ) {
+			std::memset(tail, ' ', sizeof(tail));
+			std::memcpy(tail, p, str.size() - base);
+			p = tail;
+		}
+
+		block_masks m;
+		classify(p, m);
+
+		uint64_t quote = m.quote & ~find_escaped(m.backslash, prev_escaped);
+		uint64_t in_string = prefix_xor(quote) ^ prev_in_string;
+		prev_in_string = in_string >> 63 ? ~0ULL : 0;
+
+		if ( m.tick & ~in_string )
+			return false;
+
+		uint64_t scalar = ~( m.op | m.ws | quote | in_string );
+		uint64_t structural = ( m.op & ~in_string ) | ( quote & in_string ) |
+					( scalar & ~(( scalar << 1 ) | prev_scalar ));
+		prev_scalar = scalar >> 63;
+
+		while ( structural ) {
+			index.push_back((uint32_t)( base + trailing_zeros(structural)));
+			structural &= structural - 1;
+		}
+	}
+
+	return true;
+}
+
+/*
+ *Stage 2, walks the index and reports values to tree_builder the same way
+ *event_parser does for Load, so it accepts the same input and fails with the
+ *same errors. Nesting is tracked on an explicit stack. Every method returns
+ *false when parsing should stop, offset is then where it stopped.
+ */
+struct indexed_parser {
+
+	std::string_view str;
+	const std::vector<uint32_t> &index;
+	tree_builder &builder;
+	std::error_code &ec;
+	size_t pos = 0;
+	size_t offset = 0; // where token at pos begins, or what follows a scalar that does not end at it
+	unsigned max_depth = 0;
+	std::string buffer;
+	std::vector<bool> stack; // true for objects
+
+	indexed_parser(std::string_view str, const std::vector<uint32_t> &index, tree_builder &builder, std::error_code &ec):
+		str(str), index(index), builder(builder), ec(ec) {
+		offset = index.empty() ? str.size() : index[0];
+	}
+
+	char token() const {
+		return char_at(str, offset);
+	}
+
+	void advance() {
+		++pos;
+		offset = pos < index.size() ? index[pos] : str.size();
+	}
+
+	/*
+	 *Moves past a scalar ending at offset. Anything else than a structural
+	 *following it stays at offset, for the caller to report like Load does.
+	 */
+	void resume() {
+		consume_ws(str, offset);
+		while ( pos < index.size() && index[pos] < offset )
+			++pos;
+	}
+
+	bool scalar(JSON &&value) {
+
+		if ( ec )
+			return false;
+
+		switch ( value.JSONType()) {
+			case JSON::Class::Boolean:
+				return builder.boolean(value.to_bool());
+			case JSON::Class::Integral:
+				return builder.integral(value.to_int());
+			case JSON::Class::Floating:
+				return builder.floating(value.to_float());
+			default:
+				return builder.null();
+		}
+	}
+
+	/*
+	 *Parses key and the colon after it. Keys that are not strings
+	 *are taken as their text, arrays and objects minified.
+	 */
+	bool member() {
+
+		char c = token();
+		JSON key;
+
+		switch ( c ) {
+			case '\"':
+				if ( !parse_string(str, c, offset, buffer, ec) || !builder.key(buffer))
+					return false;
+				break;
+			case '[':
+			case '{': {
+				// parsed as a value of its own, within what is left of depth limit
+				if ( max_depth != 0 && stack.size() >= max_depth ) {
+					ec = JSON::make_error_code(JSON::error::depth_limit_exceeded);
+					return false;
+				}
+
+				tree_builder::key_table table;
+				tree_builder keys(table);
+				indexed_parser nested(str, index, keys, ec);
+
+				nested.pos = pos;
+				nested.offset = offset;
+				nested.max_depth = max_depth == 0 ? 0 : max_depth - (unsigned)stack.size();
+				bool ok = nested.value();
+
+				pos = nested.pos;
+				offset = nested.offset;
+				if ( !ok )
+					return false;
+
+				key = keys.finish();
+			} break;
+			case 't':
+			case 'f':
+				key = parse_bool(str, offset, ec);
+				break;
+			case 'n':
+				key = parse_null(str, offset, ec);
+				break;
+			default:
+				if (( c <= '9' && c >= '0') || c == '-' )
+					key = parse_number(str, offset, ec);
+		}
+
+		if ( ec )
+			return false;
+
+		if ( c != '\"' ) {
+			buffer = key.to_unescaped_string();
+			if ( !builder.key(buffer))
+				return false;
+		}
+
+		resume();
+		if ( token() != ':' ) {
+			ec = JSON::make_error_code(JSON::error::object_missing_colon);
+			return false;
+		}
+
+		advance();
+		return true;
+	}
+
+	bool scalar_value() {
+
+		char c = token();
+		bool ok;
+
+		switch ( c ) {
+			case '\"':
+				ok = parse_string(str, c, offset, buffer, ec) && builder.string(buffer);
+				break;
+			case 't':
+			case 'f':
+				ok = scalar(parse_bool(str, offset, ec));
+				break;
+			case 'n':
+				ok = scalar(parse_null(str, offset, ec));
+				break;
+			default:
+				if (( c <= '9' && c >= '0') || c == '-' ) {
+					if ( builder.lazy_numbers ) {
+						size_t start = offset;
+						JSON::Class type = scan_number(str, offset, ec);
+						ok = !ec && builder.number(str.substr(start, offset - start), type);
+					} else ok = scalar(parse_number(str, offset, ec));
+				} else return builder.null(); // missing value, nothing to move past
+		}
+
+		if ( ok )
+			resume();
+		return ok;
+	}
+
+	bool value() {
+
+		while (true) {
+
+			char c = token();
+
+			if ( c == '[' || c == '{' ) {
+
+				bool object = c == '{';
+
+				if ( max_depth != 0 && stack.size() >= max_depth ) {
+					ec = JSON::make_error_code(JSON::error::depth_limit_exceeded);
+					return false;
+				}
+
+				advance();
+				if ( !( object ? builder.start_object() : builder.start_array()))
+					return false;
+
+				stack.push_back(object);
+
+				// first member or element, empty ones are closed below
+				if ( token() != ( object ? '}' : ']' )) {
+					if ( object && !member())
+						return false;
+					continue;
+				}
+
+			} else if ( !scalar_value())
+				return false;
+
+			// value is complete, close containers that end here
+			while (true) {
+
+				if ( stack.empty())
+					return true;
+
+				bool object = stack.back();
+				c = token();
+
+				if ( c == ',' ) {
+					advance();
+					if ( object && !member())
+						return false;
+					break;
+				} else if ( c != ( object ? '}' : ']' )) {
+					ec = JSON::make_error_code(object ? JSON::error::object_missing_comma :
+							JSON::error::array_missing_comma_or_bracket);
+					return false;
+				}
+
+				advance();
+				stack.pop_back();
+
+				if ( !( object ? builder.end_object() : builder.end_array()))
+					return false;
+			}
+		}
+	}
+};
+
+JSON JSON::LoadIndexed(std::string_view str, const JSON::ParseOptions &options, std::error_code &ec, size_t &offset) noexcept {
+
+	std::vector<uint32_t> index;
+	tree_builder::key_table keys;
+	tree_builder builder(keys);
+
+	builder.resource = options.resource;
+	builder.layout = options.object_layout;
+	builder.pack = options.pack_arrays;
+	builder.lazy_numbers = options.lazy_numbers;
+
+	if ( build_index(str, index)) {
+
+		indexed_parser parser(str, index, builder, ec);
+
+		parser.max_depth = options.max_depth;
+		parser.value();
+		offset = parser.offset;
+	} else {
+
+		event_parser<tree_builder> parser(str, builder, ec);
+
+		parser.max_depth = options.max_depth;
+		parser.value();
+		offset = parser.offset;
+	}
+
+	return builder.finish();
+}
+
+JSON JSON::LoadIndexed(std::string_view str, const JSON::ParseOptions &options, std::error_code &ec) noexcept {
+
+	size_t offset;
+	return JSON::LoadIndexed(str, options, ec, offset);
+}
+
+JSON JSON::LoadIndexed(std::string_view str, const JSON::ParseOptions &options) {
+
+	std::error_code ec;
+	if ( JSON obj = JSON::LoadIndexed(str, options, ec); !ec )
+		return obj;
+	else throw std::runtime_error(ec.message());
+}
+
+JSON JSON::LoadIndexed(std::string_view str, std::error_code &ec) noexcept {
+
+	return JSON::LoadIndexed(str, JSON::ParseOptions(), ec);
+}
+
+JSON JSON::LoadIndexed(std::string_view str) {
+
+	return JSON::LoadIndexed(str, JSON::ParseOptions());
+}
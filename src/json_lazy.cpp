@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <cstring>
+#include "json.hpp"
+#include "parser.hpp"
+
+static constexpr size_t npos = std::string_view::npos;
+
+static inline size_t skip_ws(std::string_view str, size_t offset) {
+	consume_ws(str, offset);
+	return offset;
+}
+
+size_t skip_string(std::string_view str, size_t offset) {
+
+	char tick = str[offset++];
+
+	while ( offset < str.size()) {
+
+		const char *end = static_cast<const char*>(std::memchr(str.data() + offset, tick, str.size() - offset));
+
+		if ( end == nullptr )
+			return npos;
+
+		// closing tick is escaped if preceded by odd number of backslashes
+		size_t pos = end - str.data(), backslashes = 0;
+		while ( pos - backslashes > offset && str[pos - backslashes - 1] == '\\' ) ++backslashes;
+
+		offset = pos + 1;
+		if ( backslashes % 2 == 0 )
+			return offset;
+	}
+
+	return npos;
+}
+
+size_t skip_value(std::string_view str, size_t offset) {
+
+	if ( offset >= str.size())
+		return npos;
+
+	switch ( str[offset] ) {
+		case '\"':
+		case '\'':
+			return skip_string(str, offset);
+		case '{':
+		case '[': {
+			static const struct table {
+				bool special[256] = {};
+				table() {
+					for ( unsigned char c : std::string_view("\"'{}[]"))
+						special[c] = true;
+				}
+			} lookup;
+
+			const char *data = str.data();
+			size_t depth = 0;
+
+			while ( offset < str.size()) {
+
+				while ( !lookup.special[(unsigned char)data[offset]] )
+					if ( ++offset == str.size())
+						return npos;
+
+				switch ( data[offset] ) {
+					case '\"':
+					case '\'':
+						if (( offset = skip_string(str, offset)) == npos )
+							return npos;
+						continue;
+					case '{':
+					case '[':
+						++depth;
+						break;
+					default:
+						if ( --depth == 0 )
+							return offset + 1;
+				}
+
+				++offset;
+			}
+
+			return npos;
+		}
+		default:
+			while ( offset < str.size() && !isspace((unsigned char)str[offset]) &&
+				str[offset] != ',' && str[offset] != ']' && str[offset] != '}' && str[offset] != ':' )
+				++offset;
+			return offset;
+	}
+}
+
+/*
+ *Walks object members or array elements, calling fn(key_offset, value_offset)
+ *until it returns false. For arrays key_offset is npos.
+ */
+template <typename F>
+static void for_each_item(std::string_view str, F &&fn) {
+
+	bool object = str[0] == '{';
+	size_t offset = skip_ws(str, 1);
+
+	if ( char_at(str, offset) == ( object ? '}' : ']' ))
+		return;
+
+	while ( offset < str.size()) {
+
+		size_t key = npos;
+
+		if ( object ) {
+			key = offset;
+			if (( offset = skip_value(str, offset)) == npos )
+				return;
+			offset = skip_ws(str, offset);
+			if ( char_at(str, offset) != ':' )
+				return;
+			offset = skip_ws(str, offset + 1);
+		}
+
+		if ( !fn(key, offset) || ( offset = skip_value(str, offset)) == npos )
+			return;
+
+		offset = skip_ws(str, offset);
+		if ( char_at(str, offset) != ',' )
+			return;
+
+		offset = skip_ws(str, offset + 1);
+	}
+}
+
+JSON::LazyView::LazyView(std::string_view str) {
+
+	size_t offset = skip_ws(str, 0);
+	this -> str = offset < str.size() ? str.substr(offset) : std::string_view();
+}
+
+JSON::Class JSON::LazyView::JSONType() const {
+
+	switch ( char_at(str, 0)) {
+		case '{':
+			return Class::Object;
+		case '[':
+			return Class::Array;
+		case '\"':
+		case '\'':
+			return Class::String;
+		case 't':
+		case 'f':
+			return Class::Boolean;
+		case '-':
+		case '0': case '1': case '2': case '3': case '4':
+		case '5': case '6': case '7': case '8': case '9': {
+			std::error_code ec;
+			return JSON::Load(str, ec).JSONType();
+		}
+		default:
+			return Class::Null;
+	}
+}
+
+JSON::LazyView JSON::LazyView::operator[](std::string_view key) const {
+
+	if ( char_at(str, 0) != '{' )
+		return LazyView();
+
+	LazyView result;
+	std::string buffer;
+
+	for_each_item(str, [this, &key, &result, &buffer](size_t key_offset, size_t value_offset) {
+
+		char c = str[key_offset];
+		bool match;
+
+		if ( c == '\"' || c == '\'' ) {
+
+			size_t end = skip_string(str, key_offset);
+			std::string_view raw = str.substr(key_offset + 1, end == npos ? 0 : end - key_offset - 2);
+
+			// compared escaped, the way Load stores keys, decoding only keys that need it
+			if ( std::find_if(raw.begin(), raw.end(), [](char ch) {
+					return ch == '\"' || ch == '\\' || (unsigned char)ch < 0x20; }) == raw.end())
+				match = raw == key;
+			else {
+				std::error_code ec;
+				match = parse_string(str, c, key_offset, buffer, ec) && json_escape(buffer) == key;
+			}
+		} else {
+			// keys that are not strings are taken as their text, like Load does
+			std::error_code ec;
+			match = json_escape(JSON::Load(str.substr(key_offset), ec).to_unescaped_string()) == key;
+		}
+
+		if ( match )
+			result.str = str.substr(value_offset);
+
+		return true;
+	});
+
+	return result;
+}
+
+JSON::LazyView JSON::LazyView::operator[](unsigned index) const {
+
+	if ( char_at(str, 0) != '[' )
+		return LazyView();
+
+	LazyView result;
+	unsigned i = 0;
+
+	for_each_item(str, [this, &index, &result, &i](size_t, size_t value_offset) {
+
+		if ( i++ != index )
+			return true;
+
+		result.str = str.substr(value_offset);
+		return false;
+	});
+
+	return result;
+}
+
+JSON::LazyView JSON::LazyView::at(std::string_view key) const {
+
+	if ( LazyView value = operator[](key); value.exists())
+		return value;
+	else throw std::out_of_range("JSON::LazyView::at: key not found");
+}
+
+JSON::LazyView JSON::LazyView::at(unsigned index) const {
+
+	if ( LazyView value = operator[](index); value.exists())
+		return value;
+	else throw std::out_of_range("JSON::LazyView::at: index out of range");
+}
+
+std::size_t JSON::LazyView::size() const {
+
+	char c = char_at(str, 0);
+
+	if ( c != '{' && c != '[' )
+		return -1;
+
+	std::size_t count = 0;
+	for_each_item(str, [&count](size_t, size_t) {
+		++count;
+		return true;
+	});
+
+	return count;
+}
+
+std::string_view JSON::LazyView::raw() const {
+
+	size_t end = skip_value(str, 0);
+	return str.substr(0, end);
+}
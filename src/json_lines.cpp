@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <cstring>
+#include "json.hpp"
+#include "parser.hpp"
+#include "parallel.hpp"
+#include "file.hpp"
+
+/*
+ *Input is cut into chunks at line boundaries, workers take chunks one
+ *at a time and parse the lines within them in order.
+ */
+static constexpr size_t min_chunk_size = 64 * 1024;
+
+struct lines_chunk {
+	std::string_view data;
+	size_t first_line = 0;
+	std::vector<JSON> values;
+	std::vector<std::error_code> errors;
+};
+
+static std::vector<lines_chunk> split_lines(std::string_view str, unsigned threads) {
+
+	if ( threads == 0 )
+		threads = std::thread::hardware_concurrency();
+
+	size_t count = std::max<size_t>(1, std::min<size_t>(( threads ? threads : 1 ) * 4, str.size() / min_chunk_size));
+	size_t target = str.size() / count + 1;
+	std::vector<lines_chunk> chunks;
+
+	for ( size_t offset = 0; offset < str.size(); ) {
+
+		size_t end = offset + target;
+
+		if ( end >= str.size())
+			end = str.size();
+		else {
+			const char *nl = static_cast<const char*>(std::memchr(str.data() + end, '\n', str.size() - end));
+			end = nl ? nl - str.data() + 1 : str.size();
+		}
+
+		lines_chunk chunk;
+		chunk.data = str.substr(offset, end - offset);
+		chunks.push_back(std::move(chunk));
+		offset = end;
+	}
+
+	return chunks;
+}
+
+template <typename F>
+static void parse_lines(std::string_view data, size_t line, const JSON::ParseOptions &options, F &&fn) {
+
+	// records of a chunk share their keys
+	tree_builder::key_table keys;
+
+	for ( size_t offset = 0; offset < data.size(); ++line ) {
+
+		const char *nl = static_cast<const char*>(std::memchr(data.data() + offset, '\n', data.size() - offset));
+		size_t end = nl ? nl - data.data() : data.size();
+		std::string_view record = data.substr(offset, end - offset);
+		offset = end + 1;
+
+		// blank lines keep their place, so entries match line numbers
+		if ( std::all_of(record.begin(), record.end(), [](char c) { return isspace((unsigned char)c); })) {
+			fn(line, JSON(), JSON::make_error_code(JSON::error::blank_line));
+			continue;
+		}
+
+		std::error_code ec;
+		JSON value = load_interned(record, keys, options, ec);
+		fn(line, std::move(value), ec);
+	}
+}
+
+std::vector<JSON> JSON::LoadLines(std::string_view str, std::vector<std::error_code> &errors, const JSON::ParseOptions &options, unsigned threads) {
+
+	std::vector<lines_chunk> chunks = split_lines(str, threads);
+
+	run_parallel(chunks.size(), threads, [&chunks, &options](size_t i) {
+		lines_chunk &chunk = chunks[i];
+		parse_lines(chunk.data, 0, options, [&chunk](size_t, JSON &&value, const std::error_code &ec) {
+			chunk.values.push_back(std::move(value));
+			chunk.errors.push_back(ec);
+		});
+	});
+
+	size_t total = 0;
+	for ( auto &chunk : chunks )
+		total += chunk.values.size();
+
+	std::vector<JSON> values;
+	values.reserve(total);
+	errors.clear();
+	errors.reserve(total);
+
+	for ( auto &chunk : chunks ) {
+		std::move(chunk.values.begin(), chunk.values.end(), std::back_inserter(values));
+		errors.insert(errors.end(), chunk.errors.begin(), chunk.errors.end());
+	}
+
+	return values;
+}
+
+std::vector<JSON> JSON::LoadLines(std::string_view str, std::vector<std::error_code> &errors, unsigned threads) {
+
+	return JSON::LoadLines(str, errors, JSON::ParseOptions(), threads);
+}
+
+void JSON::LoadLines(std::string_view str, const std::function<void(size_t, JSON&&, const std::error_code&)> &callback, const JSON::ParseOptions &options, unsigned threads) {
+
+	std::vector<lines_chunk> chunks = split_lines(str, threads);
+
+	// line numbers of chunks are needed before parsing can start
+	run_parallel(chunks.size(), threads, [&chunks](size_t i) {
+		chunks[i].first_line = std::count(chunks[i].data.begin(), chunks[i].data.end(), '\n');
+	});
+
+	for ( size_t i = 0, line = 0; i < chunks.size(); ++i ) {
+		size_t lines = chunks[i].first_line;
+		chunks[i].first_line = line;
+		line += lines;
+	}
+
+	run_parallel(chunks.size(), threads, [&chunks, &callback, &options](size_t i) {
+		parse_lines(chunks[i].data, chunks[i].first_line, options, callback);
+	});
+}
+
+void JSON::LoadLines(std::string_view str, const std::function<void(size_t, JSON&&, const std::error_code&)> &callback, unsigned threads) {
+
+	JSON::LoadLines(str, callback, JSON::ParseOptions(), threads);
+}
+
+std::vector<JSON> JSON::LoadLinesFile(const std::string &path, std::vector<std::error_code> &errors, const JSON::ParseOptions &options, std::error_code &ec, unsigned threads) {
+
+	mapped_file file(path, ec);
+
+	if ( ec ) {
+		errors.clear();
+		return {};
+	}
+
+	return JSON::LoadLines(file.data(), errors, options, threads);
+}
+
+std::vector<JSON> JSON::LoadLinesFile(const std::string &path, std::vector<std::error_code> &errors, std::error_code &ec, unsigned threads) {
+
+	return JSON::LoadLinesFile(path, errors, JSON::ParseOptions(), ec, threads);
+}
@@ -0,0 +1,168 @@
+#include <algorithm>
+#include "json.hpp"
+
+static inline bool key_less(const JSON::ObjectStorage::value_type &a, const JSON::ObjectStorage::value_type &b) noexcept {
+	return a.first < b.first;
+}
+
+template <typename Entries>
+static inline auto lower_bound_key(Entries &entries, std::string_view key) noexcept {
+	return std::lower_bound(entries.begin(), entries.end(), key,
+		[](const JSON::ObjectStorage::value_type &entry, std::string_view k) { return std::string_view(entry.first) < k; });
+}
+
+/*
+ *Returns position of key in entries, or size of entries if it is missing.
+ *Objects with hash index are looked up through it, small ones are searched.
+ */
+std::size_t JSON::ObjectStorage::position(std::string_view key) const noexcept {
+
+	if ( index.empty() && mode == ObjectLayout::Sorted ) {
+
+		auto it = lower_bound_key(entries, key);
+		return it != entries.end() && it -> first == key ? (std::size_t)( it - entries.begin()) : entries.size();
+
+	} else if ( index.empty()) {
+
+		for ( std::size_t i = 0; i < entries.size(); ++i )
+			if ( entries[i].first == key )
+				return i;
+
+		return entries.size();
+	}
+
+	std::uint32_t i = index[slot(key, std::hash<std::string_view>()(key))];
+	return i != 0 ? i - 1 : entries.size();
+}
+
+/*
+ *Open addressing with linear probing. Returns slot holding key, or the free slot
+ *where it would be placed. Index is never more than half full, so a free slot exists.
+ *hash must be std::hash of key.
+ */
+std::size_t JSON::ObjectStorage::slot(std::string_view key, std::size_t hash) const noexcept {
+
+	std::size_t mask = index.size() - 1;
+	std::size_t i = hash & mask;
+
+	while ( index[i] != 0 && entries[index[i] - 1].first != key )
+		i = ( i + 1 ) & mask;
+
+	return i;
+}
+
+void JSON::ObjectStorage::reindex() {
+
+	std::size_t capacity = 16;
+	while ( capacity < entries.size() * 2 )
+		capacity <<= 1;
+
+	index.assign(capacity, 0);
+
+	for ( std::size_t i = 0; i < entries.size(); ++i )
+		index[slot(entries[i].first, std::hash<std::string_view>()(entries[i].first))] = (std::uint32_t)( i + 1 );
+}
+
+/*
+ *Adds key that is not in object yet. Sorted objects insert it in order, moving
+ *later entries, and positions in index are moved along with them.
+ */
+JSON &JSON::ObjectStorage::add(std::string &&key, JSON &&value) {
+
+	std::size_t pos = entries.size();
+
+	if ( mode == ObjectLayout::Sorted ) {
+
+		pos = lower_bound_key(entries, key) - entries.begin();
+		entries.emplace(entries.begin() + pos, std::move(key), std::move(value));
+
+		if ( !index.empty() && index.size() >= entries.size() * 2 && pos + 1 != entries.size())
+			for ( auto &i : index )
+				if ( i > pos )
+					++i;
+
+	} else entries.emplace_back(std::move(key), std::move(value));
+
+	if ( mode != ObjectLayout::Hashed && entries.size() <= linear_limit )
+		return entries[pos].second;
+	else if ( index.size() < entries.size() * 2 )
+		reindex();
+	else index[slot(entries[pos].first, std::hash<std::string_view>()(entries[pos].first))] = (std::uint32_t)( pos + 1 );
+
+	return entries[pos].second;
+}
+
+JSON &JSON::ObjectStorage::operator[](std::string_view key) {
+
+	if ( std::size_t i = position(key); i != entries.size())
+		return entries[i].second;
+
+	return add(std::string(key), JSON());
+}
+
+void JSON::ObjectStorage::insert_or_assign(std::string key, JSON &&value) {
+
+	if ( std::size_t i = position(key); i != entries.size())
+		entries[i].second = std::move(value);
+	else add(std::move(key), std::move(value));
+}
+
+void JSON::ObjectStorage::append(std::string key, JSON &&value) {
+
+	if ( mode == ObjectLayout::Sorted )
+		entries.emplace_back(std::move(key), std::move(value));
+	else insert_or_assign(std::move(key), std::move(value));
+}
+
+void JSON::ObjectStorage::sort() {
+
+	if ( mode != ObjectLayout::Sorted )
+		return;
+
+	if ( entries.size() < 2 || std::adjacent_find(entries.begin(), entries.end(),
+			[](const value_type &a, const value_type &b) { return !key_less(a, b); }) == entries.end()) {
+		if ( entries.size() > linear_limit )
+			reindex();
+		else index.clear();
+		return;
+	}
+
+	// stable, so of duplicate keys the one appended last stays last. Small objects
+	// are insertion sorted, that does not need a temporary buffer like stable_sort.
+	if ( entries.size() <= 32 ) {
+
+		for ( std::size_t i = 1; i < entries.size(); ++i ) {
+
+			if ( !key_less(entries[i], entries[i - 1]))
+				continue;
+
+			value_type entry = std::move(entries[i]);
+			std::size_t j = i;
+
+			for ( ; j != 0 && key_less(entry, entries[j - 1]); --j )
+				entries[j] = std::move(entries[j - 1]);
+
+			entries[j] = std::move(entry);
+		}
+
+	} else std::stable_sort(entries.begin(), entries.end(), key_less);
+
+	std::size_t out = 0;
+
+	for ( std::size_t i = 0; i < entries.size(); ++i ) {
+
+		if ( out != 0 && entries[out - 1].first == entries[i].first )
+			entries[out - 1].second = std::move(entries[i].second);
+		else {
+			if ( out != i )
+				entries[out] = std::move(entries[i]);
+			++out;
+		}
+	}
+
+	entries.erase(entries.begin() + out, entries.end());
+
+	if ( entries.size() > linear_limit )
+		reindex();
+	else index.clear();
+}
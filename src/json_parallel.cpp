@@ -0,0 +1,113 @@
+#include <new>
+#include <system_error>
+#include "json.hpp"
+#include "parser.hpp"
+#include "parallel.hpp"
+
+/*
+ *Arrays smaller than this are not worth splitting.
+ */
+static constexpr size_t min_parallel_size = 1024 * 1024;
+
+/*
+ *Finds where elements of top-level array start and end. Returns false
+ *when array is not well-formed enough to split, leaving it for Load.
+ */
+static bool split_array(std::string_view str, size_t offset, std::vector<std::string_view> &elements) {
+
+	consume_ws(str, ++offset);
+	if ( char_at(str, offset) == ']' )
+		return true;
+
+	while (true) {
+
+		size_t end = skip_value(str, offset);
+
+		if ( end == std::string_view::npos || end == offset )
+			return false;
+
+		elements.push_back(str.substr(offset, end - offset));
+		consume_ws(str, end);
+
+		if ( char_at(str, end) == ']' )
+			return true;
+		else if ( char_at(str, end) != ',' )
+			return false;
+
+		offset = end + 1;
+		consume_ws(str, offset);
+	}
+}
+
+JSON JSON::LoadParallel(std::string_view str, const JSON::ParseOptions &options, std::error_code &ec, unsigned threads) noexcept {
+
+	// threads that fail to start and running out of memory are reported in ec
+	try {
+
+		size_t offset = 0;
+		std::vector<std::string_view> elements;
+
+		consume_ws(str, offset);
+
+		if ( str.size() < min_parallel_size || char_at(str, offset) != '[' || options.max_depth == 1 ||
+			!split_array(str, offset, elements) || elements.size() < 2 )
+			return JSON::Load(str, options, ec);
+
+		JSON result = JSON::Make(JSON::Class::Array, options.resource);
+		JSON::ArrayStorage &list = *result.Internal.List;
+		size_t tasks = std::min<size_t>(elements.size(), ( threads ? threads : std::thread::hardware_concurrency() + 1 ) * 8);
+		std::vector<std::error_code> errors(tasks);
+
+		list.resize(elements.size());
+
+		// elements are nested in top-level array, one level of depth limit is used by it
+		JSON::ParseOptions element_options = options;
+		if ( options.max_depth != 0 )
+			--element_options.max_depth;
+
+		// every task fills its own range of elements
+		run_parallel(tasks, threads, [&elements, &list, &errors, &element_options, tasks](size_t task) {
+
+			size_t first = elements.size() * task / tasks;
+			size_t last = elements.size() * ( task + 1 ) / tasks;
+			tree_builder::key_table keys;
+
+			for ( size_t i = first; i < last && !errors[task]; ++i )
+				list[i] = load_interned(elements[i], keys, element_options, errors[task]);
+		});
+
+		for ( auto &error : errors )
+			if ( error )
+				return JSON::Load(str, options, ec);
+
+		if ( options.pack_arrays && list.size() >= JSON::PackThreshold )
+			result.pack();
+
+		return result;
+
+	} catch (const std::system_error &e) {
+		ec = e.code();
+	} catch (const std::bad_alloc &) {
+		ec = std::make_error_code(std::errc::not_enough_memory);
+	}
+
+	return JSON();
+}
+
+JSON JSON::LoadParallel(std::string_view str, const JSON::ParseOptions &options, unsigned threads) {
+
+	std::error_code ec;
+	if ( JSON obj = JSON::LoadParallel(str, options, ec, threads); !ec )
+		return obj;
+	else throw std::runtime_error(ec.message());
+}
+
+JSON JSON::LoadParallel(std::string_view str, std::error_code &ec, unsigned threads) noexcept {
+
+	return JSON::LoadParallel(str, JSON::ParseOptions(), ec, threads);
+}
+
+JSON JSON::LoadParallel(std::string_view str, unsigned threads) {
+
+	return JSON::LoadParallel(str, JSON::ParseOptions(), threads);
+}
@@ -0,0 +1,285 @@
+#include <cstring>
+#include "json.hpp"
+#include "parser.hpp"
+
+static inline bool is_ws(char c) noexcept {
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline bool is_bare(char c) noexcept {
+	return ( c >= '0' && c <= '9' ) || ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' ) ||
+		c == '-' || c == '+' || c == '.';
+}
+
+bool JSON::Parser::complete(JSON &&value) {
+
+	if ( stack.empty()) {
+		completed.push_back(std::move(value));
+		return true;
+	}
+
+	Frame &frame = stack.back();
+
+	switch ( frame.expect ) {
+		case Expect::ArrayValueOrEnd:
+		case Expect::ArrayValue:
+			frame.value.Internal.List -> push_back(std::move(value));
+			frame.expect = Expect::ArrayCommaOrEnd;
+			break;
+		case Expect::ObjectKeyOrEnd:
+		case Expect::ObjectKey:
+			frame.key = std::move(value);
+			frame.expect = Expect::ObjectColon;
+			break;
+		case Expect::ObjectValue: {
+			const std::string &key = frame.key.is_string() ? keys.intern(frame.key.StringView()) :
+				keys.intern(frame.key.to_unescaped_string());
+			frame.value.Internal.Map -> append(key, std::move(value));
+			frame.expect = Expect::ObjectCommaOrEnd;
+		} break;
+		default:
+			error = JSON::make_error_code(JSON::error::unknown_starting_char);
+			return false;
+	}
+
+	return true;
+}
+
+bool JSON::Parser::complete_string() {
+
+	size_t offset = 0;
+	std::string str;
+	JSON value;
+
+	if ( parse_string(token, tick, offset, str, error))
+		value.SetString(str, resource);
+
+	lex = Lex::None;
+	token.clear();
+	return !error && complete(std::move(value));
+}
+
+bool JSON::Parser::complete_bare() {
+
+	size_t offset = 0;
+	JSON value;
+
+	switch ( token[0] ) {
+		case 't':
+		case 'f':
+			value = parse_bool(token, offset, error);
+			if ( !error && offset != token.size())
+				error = JSON::make_error_code(JSON::error::bool_wrong_text);
+			break;
+		case 'n':
+			value = parse_null(token, offset, error);
+			if ( !error && offset != token.size())
+				error = JSON::make_error_code(JSON::error::null_wrong_text);
+			break;
+		default:
+			if (( token[0] >= '0' && token[0] <= '9' ) || token[0] == '-' ) {
+				if ( !lazy_numbers )
+					value = parse_number(token, offset, error);
+				else if ( JSON::Class type = scan_number(token, offset, error); !error )
+					value = JSON::MakeRaw(std::string_view(token).substr(0, offset), type, resource);
+				if ( !error && offset != token.size())
+					error = JSON::make_error_code(JSON::error::number_unexpected_char);
+			} else error = JSON::make_error_code(JSON::error::unknown_starting_char);
+	}
+
+	lex = Lex::None;
+	token.clear();
+	return !error && complete(std::move(value));
+}
+
+bool JSON::Parser::token_start(char c) {
+
+	if (( c == '{' || c == '[' ) && max_depth != 0 && stack.size() >= max_depth ) {
+		error = JSON::make_error_code(JSON::error::depth_limit_exceeded);
+		return false;
+	}
+
+	switch ( c ) {
+		case '{':
+			stack.push_back({ JSON::Make(JSON::Class::Object, layout, resource), JSON(), Expect::ObjectKeyOrEnd });
+			return true;
+		case '[':
+			stack.push_back({ JSON::Make(JSON::Class::Array, resource), JSON(), Expect::ArrayValueOrEnd });
+			return true;
+		case '\"':
+		case '\'':
+			lex = Lex::String;
+			tick = c;
+			token += c;
+			return true;
+		default:
+			if ( is_bare(c)) {
+				lex = Lex::Bare;
+				token += c;
+				return true;
+			}
+	}
+
+	error = JSON::make_error_code(JSON::error::unknown_starting_char);
+	return false;
+}
+
+bool JSON::Parser::structural(char c) {
+
+	Expect expect = stack.empty() ? Expect::Value : stack.back().expect;
+
+	switch ( expect ) {
+		case Expect::ArrayValueOrEnd:
+		case Expect::ObjectKeyOrEnd:
+			if ( c == ( expect == Expect::ArrayValueOrEnd ? ']' : '}' ))
+				break;
+			[[fallthrough]];
+		case Expect::Value:
+		case Expect::ArrayValue:
+		case Expect::ObjectKey:
+		case Expect::ObjectValue:
+			return token_start(c);
+		case Expect::ObjectColon:
+			if ( c != ':' ) {
+				error = JSON::make_error_code(JSON::error::object_missing_colon);
+				return false;
+			}
+			stack.back().expect = Expect::ObjectValue;
+			return true;
+		case Expect::ArrayCommaOrEnd:
+			if ( c == ',' ) {
+				stack.back().expect = Expect::ArrayValue;
+				return true;
+			} else if ( c != ']' ) {
+				error = JSON::make_error_code(JSON::error::array_missing_comma_or_bracket);
+				return false;
+			}
+			break;
+		case Expect::ObjectCommaOrEnd:
+			if ( c == ',' ) {
+				stack.back().expect = Expect::ObjectKey;
+				return true;
+			} else if ( c != '}' ) {
+				error = JSON::make_error_code(JSON::error::object_missing_comma);
+				return false;
+			}
+			break;
+	}
+
+	// container closes
+	if ( stack.back().value.Type == JSON::Class::Object )
+		stack.back().value.Internal.Map -> sort();
+	else if ( pack_arrays && stack.back().value.Internal.List -> size() >= JSON::PackThreshold )
+		stack.back().value.pack();
+
+	JSON value = std::move(stack.back().value);
+	stack.pop_back();
+	return complete(std::move(value));
+}
+
+bool JSON::Parser::feed(const char *data, size_t len, std::error_code &ec) noexcept {
+
+	size_t i = 0;
+
+	while ( !error && i < len ) {
+
+		switch ( lex ) {
+			case Lex::None:
+				if ( !is_ws(data[i]))
+					structural(data[i]);
+				++i;
+				break;
+			case Lex::String: {
+				const char *end = static_cast<const char*>(std::memchr(data + i, tick, len - i));
+				const char *escape = static_cast<const char*>(std::memchr(data + i, '\\', ( end ? end : data + len ) - data - i));
+
+				if ( escape ) {
+					token.append(data + i, escape - data - i + 1);
+					i = escape - data + 1;
+					lex = Lex::Escape;
+				} else if ( end ) {
+					token.append(data + i, end - data - i + 1);
+					i = end - data + 1;
+					complete_string();
+				} else {
+					token.append(data + i, len - i);
+					i = len;
+				}
+			} break;
+			case Lex::Escape:
+				token += data[i++];
+				lex = Lex::String;
+				break;
+			case Lex::Bare: {
+				size_t start = i;
+				while ( i < len && is_bare(data[i])) ++i;
+				token.append(data + start, i - start);
+				if ( i < len )
+					complete_bare();
+			} break;
+		}
+	}
+
+	if ( error ) {
+		ec = error;
+		return false;
+	}
+
+	return ready();
+}
+
+bool JSON::Parser::feed(const char *data, size_t len) {
+
+	std::error_code ec;
+	if ( bool ret = feed(data, len, ec); !ec )
+		return ret;
+	else throw std::runtime_error(ec.message());
+}
+
+bool JSON::Parser::finish(std::error_code &ec) noexcept {
+
+	if ( !error ) {
+
+		if ( lex == Lex::String || lex == Lex::Escape )
+			error = JSON::make_error_code(JSON::error::string_missing_end_quote);
+		else if ( lex == Lex::Bare )
+			complete_bare();
+
+		if ( !error && !stack.empty())
+			error = JSON::make_error_code(JSON::error::unexpected_end_of_input);
+	}
+
+	if ( error ) {
+		ec = error;
+		return false;
+	}
+
+	return ready();
+}
+
+bool JSON::Parser::finish() {
+
+	std::error_code ec;
+	if ( bool ret = finish(ec); !ec )
+		return ret;
+	else throw std::runtime_error(ec.message());
+}
+
+JSON JSON::Parser::next() {
+
+	if ( completed.empty())
+		return JSON();
+
+	JSON value = std::move(completed.front());
+	completed.pop_front();
+	return value;
+}
+
+void JSON::Parser::reset() {
+
+	completed.clear();
+	stack.clear();
+	token.clear();
+	error.clear();
+	lex = Lex::None;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ *Internal helper, runs fn(i) for every i in [0, tasks) on a pool of threads.
+ *Calling thread takes part in work. threads = 0 uses hardware concurrency.
+ *Exceptions are passed to caller after all threads have been joined.
+ */
+template <typename F>
+void run_parallel(size_t tasks, unsigned threads, F &&fn) {
+
+	if ( threads == 0 )
+		threads = std::thread::hardware_concurrency();
+	if ( threads == 0 )
+		threads = 1;
+	if ( threads > tasks )
+		threads = tasks;
+
+	std::atomic<size_t> next { 0 };
+	std::exception_ptr error;
+	std::mutex lock;
+
+	// first exception thrown by fn is rethrown on calling thread, remaining tasks are skipped
+	auto worker = [&next, &error, &lock, &fn, tasks]() {
+		try {
+			for ( size_t i = next++; i < tasks; i = next++ )
+				fn(i);
+		} catch (...) {
+			next = tasks;
+			std::lock_guard<std::mutex> guard(lock);
+			if ( !error )
+				error = std::current_exception();
+		}
+	};
+
+	// threads are joined however this returns, also when starting one of them throws
+	struct joiner {
+		std::vector<std::thread> &pool;
+		~joiner() {
+			for ( auto &t : pool )
+				t.join();
+		}
+	};
+
+	std::vector<std::thread> pool;
+
+	{
+		joiner join { pool };
+
+		for ( unsigned i = 1; i < threads; ++i )
+			pool.emplace_back(worker);
+
+		worker();
+	}
+
+	if ( error )
+		std::rethrow_exception(error);
+}
@@ -0,0 +1,429 @@
+#pragma once
+
+#include <string_view>
+#include <type_traits>
+#include <system_error>
+#include <vector>
+#include "json.hpp"
+
+/*
+ *Internal parser primitives shared between json sources, not part of public API.
+ *All of them read input through char_at, which returns '\0' past the end of buffer.
+ */
+
+inline char char_at(std::string_view str, size_t offset) noexcept {
+	return offset < str.size() ? str[offset] : '\0';
+}
+
+void consume_ws(std::string_view str, size_t &offset);
+
+bool parse_string(std::string_view str, char tick, size_t &offset, std::string &val, std::error_code &ec) noexcept;
+
+/*
+ *Unescapes string starting at offset in place, buf must be the buffer being parsed.
+ *val is set to the decoded string within buf.
+ */
+bool parse_string_insitu(char *buf, size_t len, char tick, size_t &offset, std::string_view &val, std::error_code &ec) noexcept;
+JSON parse_string(std::string_view str, char tick, size_t &offset, std::error_code &ec) noexcept;
+JSON parse_number(std::string_view str, size_t &offset, std::error_code &ec) noexcept;
+
+/*
+ *Finds end of number starting at offset, without converting it. Returns Integral
+ *or Floating by how number is written, Null on error.
+ */
+JSON::Class scan_number(std::string_view str, size_t &offset, std::error_code &ec) noexcept;
+JSON parse_bool(std::string_view str, size_t &offset, std::error_code &ec) noexcept;
+JSON parse_null(std::string_view str, size_t &offset, std::error_code &ec) noexcept;
+
+/*
+ *Scanners that only find where a string or value starting at offset ends, without
+ *validating it. std::string_view::npos is returned when input ends early.
+ */
+size_t skip_string(std::string_view str, size_t offset);
+size_t skip_value(std::string_view str, size_t offset);
+
+/*
+ *Handler building a tree from parser events, this is what Load uses.
+ *Object keys are interned through table, escaped like they always have been.
+ *Array elements are collected on elements and moved to array when it closes,
+ *so each array is allocated once, with its final size. Open arrays are Null
+ *on stack until then. With pack set, arrays of numbers are packed.
+ *With doc set, containers and strings are taken from its pools. With
+ *lazy_numbers set, numbers are given to number as their text.
+ */
+struct tree_builder {
+
+	typedef JSON::KeyTable key_table; // private to JSON, other sources name it through here
+
+	key_table &table;
+	JSON::Document *doc = nullptr;
+	std::pmr::memory_resource *resource = nullptr;
+	JSON::ObjectLayout layout = JSON::ObjectLayout::Sorted;
+	bool pack = false;
+	bool lazy_numbers = false;
+	std::vector<JSON> stack;
+	std::vector<std::string> keys;
+	std::vector<JSON> elements;
+	std::vector<size_t> starts; // where elements of each open array begin
+	JSON result;
+
+	explicit tree_builder(key_table &table): table(table) {}
+
+	JSON make(JSON::Class type) {
+
+		JSON node;
+
+		if ( doc != nullptr && type == JSON::Class::Array && !doc -> lists.empty()) {
+			node.Internal.List = doc -> lists.back();
+			doc -> lists.pop_back();
+		} else if ( doc != nullptr && type == JSON::Class::Object && !doc -> maps.empty()) {
+			node.Internal.Map = doc -> maps.back();
+			node.Internal.Map -> reset(layout);
+			doc -> maps.pop_back();
+		} else if ( type == JSON::Class::Object )
+			return JSON::Make(type, layout, resource);
+		else return JSON::Make(type, resource);
+
+		node.Type = type;
+		return node;
+	}
+
+	template <typename T>
+	JSON make_packed(std::vector<JSON::PackedStorage<T>*> *pool, const JSON *first, const JSON *last) {
+
+		JSON node;
+		JSON::PackedStorage<T> *storage;
+
+		if ( pool != nullptr && !pool -> empty()) {
+			storage = pool -> back();
+			pool -> pop_back();
+		} else storage = JSON::Create<JSON::PackedStorage<T>>(resource);
+
+		node.Adopt(storage);
+		JSON::Pack(*storage, first, last);
+		return node;
+	}
+
+	bool value(JSON &&value) {
+
+		if ( stack.empty())
+			result = std::move(value);
+		else if ( stack.back().Type == JSON::Class::Object )
+			stack.back().Internal.Map -> append(std::move(keys.back()), std::move(value));
+		else elements.push_back(std::move(value));
+
+		return true;
+	}
+
+	bool null() {
+		return value(JSON());
+	}
+
+	bool boolean(bool b) {
+		return value(JSON(b));
+	}
+
+	bool integral(long long i) {
+		return value(JSON(i));
+	}
+
+	bool floating(double d) {
+		return value(JSON(d));
+	}
+
+	bool number(std::string_view text, JSON::Class type) {
+		return value(JSON::MakeRaw(text, type, resource));
+	}
+
+	bool string(std::string &s) {
+
+		JSON str;
+
+		if ( s.size() > JSON::SmallCapacity && doc != nullptr && !doc -> strings.empty()) {
+			str.Internal.String = doc -> strings.back();
+			str.Internal.String -> assign(s);
+			str.Type = JSON::Class::String;
+			doc -> strings.pop_back();
+		} else str.SetString(s, resource);
+
+		return value(std::move(str));
+	}
+
+	bool string(std::string_view s) {
+		return value(JSON::MakeSlice(s));
+	}
+
+	bool key(std::string &k) {
+		keys.back() = table.intern(k);
+		return true;
+	}
+
+	bool start_object() {
+		stack.push_back(make(JSON::Class::Object));
+		keys.emplace_back();
+		return true;
+	}
+
+	bool end_object() {
+		stack.back().Internal.Map -> sort();
+		JSON obj = std::move(stack.back());
+		stack.pop_back();
+		keys.pop_back();
+		return value(std::move(obj));
+	}
+
+	bool start_array() {
+		stack.emplace_back();
+		starts.push_back(elements.size());
+		return true;
+	}
+
+	bool end_array() {
+
+		auto first = elements.begin() + starts.back();
+		const JSON *begin = elements.data() + starts.back(), *end = elements.data() + elements.size();
+		JSON arr;
+
+		switch ( pack && (std::size_t)( end - begin ) >= JSON::PackThreshold ?
+				JSON::Packable(begin, end) : JSON::Packing::None ) {
+			case JSON::Packing::Floating:
+				arr = make_packed(doc != nullptr ? &doc -> floats : nullptr, begin, end);
+				break;
+			case JSON::Packing::Integral:
+				arr = make_packed(doc != nullptr ? &doc -> ints : nullptr, begin, end);
+				break;
+			default:
+				arr = make(JSON::Class::Array);
+				arr.Internal.List -> reserve(end - begin);
+				arr.Internal.List -> insert(arr.Internal.List -> end(),
+					std::make_move_iterator(first), std::make_move_iterator(elements.end()));
+		}
+
+		elements.erase(first, elements.end());
+		starts.pop_back();
+		stack.pop_back();
+		return value(std::move(arr));
+	}
+
+	/*
+	 *Closes containers left open by an error, so partial result is returned
+	 *the same way as before.
+	 */
+	JSON finish() {
+
+		while ( !stack.empty()) {
+			if ( stack.back().Type == JSON::Class::Object )
+				end_object();
+			else end_array();
+		}
+
+		return std::move(result);
+	}
+};
+
+/*
+ *Load with object keys interned through keys, so documents parsed one after
+ *another escape each of them once.
+ */
+JSON load_interned(std::string_view str, tree_builder::key_table &keys, const JSON::ParseOptions &options, std::error_code &ec) noexcept;
+
+/*
+ *Parser reporting what it finds to Handler. Nesting is tracked on an explicit
+ *stack, so deep input does not consume call stack. Every method returns false when
+ *parsing should stop, because of an error or because handler asked for it.
+ *Missing values, like in {"key": } are reported as null.
+ */
+template <typename Handler>
+struct event_parser {
+
+	std::string_view str;
+	Handler &handler;
+	std::error_code &ec;
+	size_t offset = 0;
+	unsigned max_depth = 0;
+	char *insitu = nullptr; // when set, string values are unescaped in this buffer
+	std::string buffer;
+	std::vector<bool> stack; // true for objects
+
+	event_parser(std::string_view str, Handler &handler, std::error_code &ec):
+		str(str), handler(handler), ec(ec) {}
+
+	bool scalar(JSON &&value) {
+
+		if ( ec )
+			return false;
+
+		switch ( value.JSONType()) {
+			case JSON::Class::Boolean:
+				return handler.boolean(value.to_bool());
+			case JSON::Class::Integral:
+				return handler.integral(value.to_int());
+			case JSON::Class::Floating:
+				return handler.floating(value.to_float());
+			default:
+				return handler.null();
+		}
+	}
+
+	/*
+	 *Parses key and the colon after it. Keys that are not strings
+	 *are taken as their text, arrays and objects minified.
+	 */
+	bool member() {
+
+		consume_ws(str, offset);
+		char c = char_at(str, offset);
+		JSON key;
+
+		switch ( c ) {
+			case '\"':
+			case '\'':
+				if ( !parse_string(str, c, offset, buffer, ec) || !handler.key(buffer))
+					return false;
+				break;
+			case '[':
+			case '{': {
+				// parsed as a value of its own, within what is left of depth limit
+				if ( max_depth != 0 && stack.size() >= max_depth ) {
+					ec = JSON::make_error_code(JSON::error::depth_limit_exceeded);
+					return false;
+				}
+
+				tree_builder::key_table table;
+				tree_builder builder(table);
+				event_parser<tree_builder> nested(str, builder, ec);
+
+				nested.offset = offset;
+				nested.max_depth = max_depth == 0 ? 0 : max_depth - (unsigned)stack.size();
+				if ( !nested.value())
+					return false;
+
+				offset = nested.offset;
+				key = builder.finish();
+			} break;
+			case 't':
+			case 'f':
+				key = parse_bool(str, offset, ec);
+				break;
+			case 'n':
+				key = parse_null(str, offset, ec);
+				break;
+			default:
+				if (( c <= '9' && c >= '0') || c == '-' )
+					key = parse_number(str, offset, ec);
+		}
+
+		if ( ec )
+			return false;
+
+		if ( c != '\"' && c != '\'' ) {
+			buffer = key.to_unescaped_string();
+			if ( !handler.key(buffer))
+				return false;
+		}
+
+		consume_ws(str, offset);
+		if ( char_at(str, offset) != ':' ) {
+			ec = JSON::make_error_code(JSON::error::object_missing_colon);
+			return false;
+		}
+
+		++offset;
+		return true;
+	}
+
+	bool scalar_value(char c) {
+
+		switch ( c ) {
+			case '\"':
+			case '\'':
+				if ( insitu != nullptr ) {
+					std::string_view s;
+					return parse_string_insitu(insitu, str.size(), c, offset, s, ec) && handler.string(s);
+				}
+				return parse_string(str, c, offset, buffer, ec) && handler.string(buffer);
+			case 't':
+			case 'f':
+				return scalar(parse_bool(str, offset, ec));
+			case 'n':
+				return scalar(parse_null(str, offset, ec));
+			default:
+				if (( c <= '9' && c >= '0') || c == '-' ) {
+					if constexpr ( std::is_same<Handler, tree_builder>::value ) {
+						if ( handler.lazy_numbers ) {
+							size_t start = offset;
+							JSON::Class type = scan_number(str, offset, ec);
+							return !ec && handler.number(str.substr(start, offset - start), type);
+						}
+					}
+					return scalar(parse_number(str, offset, ec));
+				}
+		}
+
+		return handler.null();
+	}
+
+	bool value() {
+
+		while (true) {
+
+			consume_ws(str, offset);
+			char c = char_at(str, offset);
+
+			if ( c == '[' || c == '{' ) {
+
+				bool object = c == '{';
+
+				if ( max_depth != 0 && stack.size() >= max_depth ) {
+					ec = JSON::make_error_code(JSON::error::depth_limit_exceeded);
+					return false;
+				}
+
+				++offset;
+				if ( !( object ? handler.start_object() : handler.start_array()))
+					return false;
+
+				stack.push_back(object);
+				consume_ws(str, offset);
+
+				// first member or element, empty ones are closed below
+				if ( char_at(str, offset) != ( object ? '}' : ']' )) {
+					if ( object && !member())
+						return false;
+					continue;
+				}
+
+			} else if ( !scalar_value(c))
+				return false;
+
+			// value is complete, close containers that end here
+			while (true) {
+
+				if ( stack.empty())
+					return true;
+
+				bool object = stack.back();
+
+				consume_ws(str, offset);
+				c = char_at(str, offset);
+
+				if ( c == ',' ) {
+					++offset;
+					if ( object && !member())
+						return false;
+					break;
+				} else if ( c != ( object ? '}' : ']' )) {
+					ec = JSON::make_error_code(object ? JSON::error::object_missing_comma :
+							JSON::error::array_missing_comma_or_bracket);
+					return false;
+				}
+
+				++offset;
+				stack.pop_back();
+
+				if ( !( object ? handler.end_object() : handler.end_array()))
+					return false;
+			}
+		}
+	}
+};